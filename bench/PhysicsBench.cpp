@@ -0,0 +1,585 @@
+// Headless PhysicsEngine benchmark. Spawns dynamic bodies and static trees
+// on a Terrain, steps the engine a fixed number of ticks and prints one
+// CSV or JSON row per body count.
+//
+//   PhysicsBench --bodies 1000,4000 --trees 200 --steps 600
+//   PhysicsBench --sweep 500:64000 --format json
+//   PhysicsBench --bodies 500 --worlds 64
+//   PhysicsBench --bodies 8000 --lod 15:30
+//   PhysicsBench --bodies 16000 --sort 30
+//   PhysicsBench --bodies 8000 --rays 4096
+//   PhysicsBench --bodies 4000 --broadphase brute --simd scalar
+//   PhysicsBench --micro 4096
+//   PhysicsBench --replay physics_recording.bin
+
+#include "Physics/PhysicsEngine.h"
+#include "Physics/PhysicsKernels.h"
+#include "Physics/PhysicsRecorder.h"
+#include "Physics/PhysicsWorldBatch.h"
+#include "Terrain.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::vector<int> bodyCounts;
+    int trees = 200;
+    int steps = 600;
+    int warmup = 60;
+    int threads = 0; // 0 = engine default
+    int iterations = 0; // Solver sweeps, 0 = engine default
+    int worlds = 1; // Independent worlds stepped together, one seed each
+    bool mixedShapes = false; // Cycle box, sphere, cylinder and cone instead of all boxes
+    float lodNear = 0.0f; // LOD band distances from the origin, off unless lodFar > 0
+    float lodFar = 0.0f;
+    int sortInterval = 0; // Spatial sort check interval in steps, 0 = off
+    float sortThreshold = 0.1f;
+    int rays = 0; // Rays cast after every timed step
+    RaycastMode raycastMode = RAYCAST_PACKET;
+    float dt = 1.0f / 60.0f;
+    float spread = 45.0f; // Bodies spawn in [-spread, spread] on X and Z
+    unsigned seed = 1;
+    BroadphaseMode broadphase = BROADPHASE_SPATIAL_HASH;
+    int simd = -1; // Forced PhysicsKernels::SimdLevel, -1 = best supported
+    int micro = 0; // Candidates per row of the pair filter microbenchmark, 0 = off
+    bool json = false;
+    std::string replayPath; // Replay a recording instead of a generated scene
+};
+
+struct Result {
+    int bodies;
+    int trees;
+    int threads;
+    int worlds;
+    int steps;
+    double nsPerStep;
+    double p50;
+    double p99;
+    double worldStepsPerSec;
+    double pairsTested;
+    double pairsRejected;
+    double pairsColliding;
+    double islands;
+    double solverIterations;
+    double sleeping;
+    double lodBodies[LOD_BAND_COUNT];
+    double disorder;
+    double spatialSorts;
+    double nsPerRay;
+    uint64_t stateHash;
+};
+
+void usage() {
+    std::printf(
+        "Usage: PhysicsBench [options]\n"
+        "  --bodies N[,N...]   Dynamic body counts to run (default 1000)\n"
+        "  --sweep MIN:MAX     Body counts doubling from MIN up to MAX\n"
+        "  --trees N           Static trees (default 200)\n"
+        "  --steps N           Timed steps per run (default 600)\n"
+        "  --warmup N          Untimed steps before timing (default 60)\n"
+        "  --threads N         Physics worker threads (default: one per core)\n"
+        "  --iterations N      Contact solver sweeps per island (default 8)\n"
+        "  --worlds N          Step N worlds at once, seeds seed..seed+N-1, one\n"
+        "                      thread per world; timings are per batch step\n"
+        "  --dt SECONDS        Step length (default 1/60)\n"
+        "  --spread UNITS      Spawn area half-extent (default 45)\n"
+        "  --seed N            Random seed (default 1)\n"
+        "  --shapes box|mixed  Dynamic body collision shapes (default box)\n"
+        "  --lod NEAR:FAR      Physics LOD around the origin: full rate within\n"
+        "                      NEAR, half rate to FAR, quarter rate beyond\n"
+        "  --sort STEPS[:MAX]  Re-sort bodies in Morton order when more than MAX\n"
+        "                      (default 0.1) are out of order, checked every STEPS\n"
+        "  --rays N            Cast N rays over the scene after each timed step\n"
+        "  --raycast packet|single\n"
+        "  --broadphase hash|brute\n"
+        "  --simd scalar|sse|avx2  Force a kernel level (default: best supported)\n"
+        "  --micro N           Time the AABB pair filter alone over N candidates\n"
+        "                      at every SIMD level, instead of the scene\n"
+        "  --format csv|json\n"
+        "  --replay FILE       Time a session recorded in the app (F9) instead;\n"
+        "                      'bodies' is then the final body count\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (arg == "--help" || arg == "-h") {
+            usage();
+            return false;
+        }
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return false;
+        }
+        i++;
+
+        if (arg == "--bodies") {
+            for (const char* p = value; *p; ) {
+                opt.bodyCounts.push_back(std::atoi(p));
+                p = std::strchr(p, ',');
+                if (!p) break;
+                p++;
+            }
+        } else if (arg == "--sweep") {
+            int lo = 0, hi = 0;
+            if (std::sscanf(value, "%d:%d", &lo, &hi) != 2 || lo <= 0 || hi < lo) {
+                std::fprintf(stderr, "Bad --sweep range: %s\n", value);
+                return false;
+            }
+            for (long n = lo; n <= hi; n *= 2) opt.bodyCounts.push_back((int)n);
+        } else if (arg == "--trees") {
+            opt.trees = std::atoi(value);
+        } else if (arg == "--steps") {
+            opt.steps = std::max(1, std::atoi(value));
+        } else if (arg == "--warmup") {
+            opt.warmup = std::max(0, std::atoi(value));
+        } else if (arg == "--threads") {
+            opt.threads = std::atoi(value);
+        } else if (arg == "--iterations") {
+            opt.iterations = std::atoi(value);
+        } else if (arg == "--worlds") {
+            opt.worlds = std::max(1, std::atoi(value));
+        } else if (arg == "--dt") {
+            opt.dt = (float)std::atof(value);
+        } else if (arg == "--spread") {
+            opt.spread = (float)std::atof(value);
+        } else if (arg == "--seed") {
+            opt.seed = (unsigned)std::strtoul(value, nullptr, 10);
+        } else if (arg == "--shapes") {
+            opt.mixedShapes = (std::strcmp(value, "mixed") == 0);
+        } else if (arg == "--lod") {
+            if (std::sscanf(value, "%f:%f", &opt.lodNear, &opt.lodFar) != 2 || opt.lodNear < 0.0f ||
+                opt.lodFar <= opt.lodNear) {
+                std::fprintf(stderr, "Bad --lod distances: %s\n", value);
+                return false;
+            }
+        } else if (arg == "--sort") {
+            if (std::sscanf(value, "%d:%f", &opt.sortInterval, &opt.sortThreshold) < 1 || opt.sortInterval < 0) {
+                std::fprintf(stderr, "Bad --sort policy: %s\n", value);
+                return false;
+            }
+        } else if (arg == "--rays") {
+            opt.rays = std::max(0, std::atoi(value));
+        } else if (arg == "--raycast") {
+            opt.raycastMode = (std::strcmp(value, "single") == 0) ? RAYCAST_SINGLE : RAYCAST_PACKET;
+        } else if (arg == "--broadphase") {
+            opt.broadphase = (std::strcmp(value, "brute") == 0) ? BROADPHASE_BRUTE_FORCE : BROADPHASE_SPATIAL_HASH;
+        } else if (arg == "--simd") {
+            if (std::strcmp(value, "scalar") == 0) opt.simd = PhysicsKernels::SIMD_SCALAR;
+            else if (std::strcmp(value, "sse") == 0) opt.simd = PhysicsKernels::SIMD_SSE;
+            else if (std::strcmp(value, "avx2") == 0) opt.simd = PhysicsKernels::SIMD_AVX2;
+            else {
+                std::fprintf(stderr, "Unknown --simd level %s\n", value);
+                return false;
+            }
+        } else if (arg == "--micro") {
+            opt.micro = std::max(0, std::atoi(value));
+        } else if (arg == "--replay") {
+            opt.replayPath = value;
+        } else if (arg == "--format") {
+            opt.json = (std::strcmp(value, "json") == 0);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            usage();
+            return false;
+        }
+    }
+    if (opt.bodyCounts.empty()) opt.bodyCounts.push_back(1000);
+    return true;
+}
+
+// Same layout as Scene: trees scattered over the terrain with the spawn
+// area kept clear, shapes dropped on top with some initial motion
+void populate(PhysicsEngine& engine, const Terrain& terrain, const Options& opt, int bodies) {
+    std::mt19937 rng(opt.seed);
+    std::uniform_real_distribution<float> treePos(-40.0f, 40.0f);
+    std::uniform_real_distribution<float> treeSize(1.5f, 3.0f);
+    std::uniform_real_distribution<float> bodyPos(-opt.spread, opt.spread);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    for (int i = 0; i < opt.trees; ) {
+        float x = treePos(rng);
+        float z = treePos(rng);
+        // Same spawn area Scene::addTrees keeps clear; try again elsewhere
+        if (x > -5 && x < 5 && z > -5 && z < 5) continue;
+        i++;
+        float size = treeSize(rng);
+
+        PhysicsObject desc;
+        desc.position = Vector3(x, terrain.getHeight(x, z), z);
+        desc.isStatic = true;
+        desc.size = Vector3(size * 0.3f, size * 5.0f, size * 0.3f);
+        desc.shape = COLLISION_CYLINDER;
+        engine.addObject(desc);
+    }
+
+    for (int i = 0; i < bodies; i++) {
+        float x = bodyPos(rng);
+        float z = bodyPos(rng);
+
+        PhysicsObject desc;
+        desc.position = Vector3(x, terrain.getHeight(x, z) + 0.5f + 4.0f * (unit(rng) + 1.0f), z);
+        desc.velocity = Vector3(5.0f * unit(rng), 0.0f, 5.0f * unit(rng));
+        desc.friction = 2.0f;
+        desc.size = Vector3(0.5f, 0.5f, 0.5f);
+        if (opt.mixedShapes) desc.shape = (CollisionShape)(i % 4);
+        // A few bodies keep pushing, like a shape driven with WASD
+        if (i % 16 == 0) desc.acceleration = Vector3(20.0f * unit(rng), 0.0f, 20.0f * unit(rng));
+        engine.addObject(desc);
+    }
+}
+
+double percentile(std::vector<double> samples, double p) {
+    size_t k = (size_t)(p * (samples.size() - 1) + 0.5);
+    std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+}
+
+// Times individual steps and accumulates the engine counters. In batch
+// runs a step covers every world and the counters are per-world averages.
+struct StepSampler {
+    std::vector<double> times;
+    double rayTime = 0, rayCount = 0;
+    double tested = 0, rejected = 0, colliding = 0, islands = 0, iterations = 0, sleeping = 0;
+    double lodBodies[LOD_BAND_COUNT] = { 0, 0, 0 };
+    double disorder = 0, spatialSorts = 0;
+
+    void step(PhysicsEngine& engine, float dt) {
+        auto t0 = std::chrono::steady_clock::now();
+        engine.update(dt);
+        auto t1 = std::chrono::steady_clock::now();
+        times.push_back((double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        count(engine.getStats(), 1.0);
+    }
+
+    void step(PhysicsWorldBatch& batch, float dt) {
+        auto t0 = std::chrono::steady_clock::now();
+        batch.step(dt);
+        auto t1 = std::chrono::steady_clock::now();
+        times.push_back((double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        for (int w = 0; w < batch.getWorldCount(); w++) {
+            count(batch.getWorld(w).getStats(), 1.0 / batch.getWorldCount());
+        }
+    }
+
+    void count(const PhysicsStats& stats, double weight) {
+        tested += stats.pairsTested * weight;
+        rejected += stats.pairsRejected * weight;
+        colliding += stats.pairsColliding * weight;
+        islands += stats.islands * weight;
+        iterations += stats.solverIterations * weight;
+        sleeping += stats.sleepingBodies * weight;
+        for (int band = 0; band < LOD_BAND_COUNT; band++) lodBodies[band] += stats.lodBodies[band] * weight;
+        disorder += stats.disorder * weight;
+        spatialSorts += stats.spatialSorts * weight;
+    }
+
+    // 'worlds' are hashed in order, so a batch hash covers every world
+    Result finish(const std::vector<const PhysicsEngine*>& worlds, int threads, int bodies, int trees) const {
+        Result r;
+        r.bodies = bodies;
+        r.trees = trees;
+        r.threads = threads;
+        r.worlds = (int)worlds.size();
+        r.steps = (int)times.size();
+
+        double n = times.empty() ? 1.0 : (double)times.size();
+        double total = 0;
+        for (double t : times) total += t;
+        r.nsPerStep = total / n;
+        r.p50 = times.empty() ? 0.0 : percentile(times, 0.50);
+        r.p99 = times.empty() ? 0.0 : percentile(times, 0.99);
+        r.worldStepsPerSec = total > 0 ? r.worlds * times.size() * 1e9 / total : 0.0;
+        r.pairsTested = tested / n;
+        r.pairsRejected = rejected / n;
+        r.pairsColliding = colliding / n;
+        r.islands = islands / n;
+        r.solverIterations = iterations / n;
+        r.sleeping = sleeping / n;
+        for (int band = 0; band < LOD_BAND_COUNT; band++) r.lodBodies[band] = lodBodies[band] / n;
+        r.disorder = disorder / n;
+        r.spatialSorts = spatialSorts; // Total over the run, not per step
+        r.nsPerRay = rayCount > 0 ? rayTime / rayCount : 0.0;
+
+        // FNV-1a over the final snapshots, to compare runs bit for bit
+        uint64_t hash = 1469598103934665603ull;
+        for (const PhysicsEngine* world : worlds) hash = world->stateHash(hash);
+        r.stateHash = hash;
+        return r;
+    }
+
+    Result finish(const PhysicsEngine& engine, int bodies, int trees) const {
+        return finish(std::vector<const PhysicsEngine*>(1, &engine), engine.getWorkerCount(), bodies, trees);
+    }
+};
+
+void attachTerrain(PhysicsEngine& engine, const Terrain& terrain) {
+    engine.sampleTerrainHeights = [&terrain](const float* x, const float* z, float* heights, size_t count) {
+        terrain.sampleHeights(x, z, heights, count);
+    };
+}
+
+// A grid of rays looking down into the scene from one eye, like a
+// screen's worth of picks, cast as one batch and timed
+struct RayGrid {
+    std::vector<PhysicsRay> rays;
+    std::vector<RaycastHit> hits;
+
+    explicit RayGrid(int count) : rays(count), hits(count) {
+        int side = std::max(1, (int)std::sqrt((double)count));
+        for (int k = 0; k < count; k++) {
+            float u = (float)(k % side) / side - 0.5f;
+            float v = (float)(k / side) / side - 0.5f;
+            rays[k] = PhysicsRay(Vector3(0.0f, 40.0f, -60.0f), Vector3(u, -0.6f + v, 1.0f), 200.0f);
+        }
+    }
+
+    void cast(PhysicsEngine& engine, StepSampler& sampler) {
+        if (rays.empty()) return;
+        auto t0 = std::chrono::steady_clock::now();
+        engine.raycastBatch(rays.data(), rays.size(), hits.data());
+        auto t1 = std::chrono::steady_clock::now();
+        sampler.rayTime += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        sampler.rayCount += (double)rays.size();
+    }
+};
+
+// Bands centred on the origin, where the app's camera starts
+void applyLod(PhysicsEngine& engine, const Options& opt) {
+    if (opt.lodFar <= 0.0f) return;
+    engine.setLodFocus(std::vector<Vector3>(1, Vector3(0.0f, 0.0f, 0.0f)));
+    engine.setLodDistances(opt.lodNear, opt.lodFar);
+    engine.setLodEnabled(true);
+}
+
+void applySort(PhysicsEngine& engine, const Options& opt) {
+    if (opt.sortInterval <= 0) return;
+    engine.setSpatialSortPolicy(opt.sortInterval, opt.sortThreshold);
+    engine.setSpatialSortEnabled(true);
+}
+
+Result run(const Options& opt, int bodies) {
+    Terrain terrain;
+    terrain.generate(opt.seed);
+
+    PhysicsEngine engine;
+    engine.setBroadphaseMode(opt.broadphase);
+    if (opt.threads > 0) engine.setWorkerCount(opt.threads);
+    if (opt.iterations > 0) engine.setSolverIterations(opt.iterations);
+    engine.setRaycastMode(opt.raycastMode);
+    applyLod(engine, opt);
+    applySort(engine, opt);
+    attachTerrain(engine, terrain);
+    populate(engine, terrain, opt, bodies);
+
+    for (int i = 0; i < opt.warmup; i++) engine.update(opt.dt);
+
+    StepSampler sampler;
+    RayGrid grid(opt.rays);
+    sampler.times.reserve(opt.steps);
+    for (int i = 0; i < opt.steps; i++) {
+        sampler.step(engine, opt.dt);
+        grid.cast(engine, sampler);
+    }
+    return sampler.finish(engine, bodies, opt.trees);
+}
+
+// Worlds share one terrain and differ in their seed, like a layout sweep
+Result runBatch(const Options& opt, int bodies) {
+    Terrain terrain;
+    terrain.generate(opt.seed);
+
+    PhysicsWorldBatch batch(opt.threads);
+    batch.setTerrain([&terrain](const float* x, const float* z, float* heights, size_t count) {
+        terrain.sampleHeights(x, z, heights, count);
+    });
+
+    std::vector<const PhysicsEngine*> worlds;
+    for (int w = 0; w < opt.worlds; w++) {
+        PhysicsEngine& world = batch.addWorld();
+        world.setBroadphaseMode(opt.broadphase);
+        if (opt.iterations > 0) world.setSolverIterations(opt.iterations);
+        applyLod(world, opt);
+        applySort(world, opt);
+        Options layout = opt;
+        layout.seed = opt.seed + w;
+        populate(world, terrain, layout, bodies);
+        worlds.push_back(&world);
+    }
+
+    batch.step(opt.dt, opt.warmup);
+
+    StepSampler sampler;
+    sampler.times.reserve(opt.steps);
+    for (int i = 0; i < opt.steps; i++) sampler.step(batch, opt.dt);
+    return sampler.finish(worlds, batch.getThreadCount(), bodies, opt.trees);
+}
+
+// Replays a session recorded in the app (F9). The terrain matches Scene's.
+bool replay(const Options& opt, Result& result) {
+    PhysicsRecorder recording;
+    if (!recording.load(opt.replayPath.c_str())) {
+        std::fprintf(stderr, "Cannot read recording %s\n", opt.replayPath.c_str());
+        return false;
+    }
+
+    Terrain terrain;
+    terrain.generate(42);
+
+    PhysicsEngine engine;
+    engine.setBroadphaseMode(opt.broadphase);
+    if (opt.threads > 0) engine.setWorkerCount(opt.threads);
+    attachTerrain(engine, terrain);
+
+    StepSampler sampler;
+    sampler.times.reserve(recording.getStepCount());
+    bool ok = recording.replay(engine, [&sampler, &engine](float dt) { sampler.step(engine, dt); });
+    if (!ok) {
+        std::fprintf(stderr, "Recording %s is malformed\n", opt.replayPath.c_str());
+        return false;
+    }
+    result = sampler.finish(engine, engine.getObjectCount(), 0);
+    return true;
+}
+
+// ================================================================
+// Pair filter microbenchmark
+// ================================================================
+
+// Times PhysicsKernels::overlapRange (a brute-force row) and overlapList
+// (a shuffled candidate list, as the spatial hash returns) for each SIMD
+// level over the same bodies; the overlapping column should match across levels
+void runMicro(const Options& opt) {
+    const int count = opt.micro + 1;
+    const int rows = 64;
+    const int repeats = std::max(1, 4000000 / count);
+
+    // The tested bodies are the first 'rows'; mixed layers, a fifth static
+    PhysicsBodyStore store;
+    store.resize(count);
+    std::vector<uint32_t> parked(count, 0u);
+    std::mt19937 rng(opt.seed);
+    std::uniform_real_distribution<float> pos(-4.0f, 4.0f);
+    for (int i = 0; i < count; i++) {
+        store.posX[i] = pos(rng);
+        store.posY[i] = pos(rng) * 0.25f;
+        store.posZ[i] = pos(rng);
+        store.sizeX[i] = store.sizeY[i] = store.sizeZ[i] = 0.5f + 0.5f * (i % 3);
+        store.category[i] = 1u << (i % 4);
+        store.mask[i] = (i % 8 == 7) ? 0x2u : ~0u;
+        store.isStatic[i] = (i % 5 == 0) ? ~0u : 0u;
+        store.isAsleep[i] = 0u;
+    }
+    std::vector<int> ids;
+    for (int i = 1; i < count; i++) ids.push_back(i);
+    std::shuffle(ids.begin(), ids.end(), rng);
+    std::vector<int> out(count);
+
+    if (opt.json) std::printf("[\n");
+    else std::printf("simd,kernel,candidates,overlapping,ns_per_candidate\n");
+
+    PhysicsKernels::SimdLevel best = PhysicsKernels::detectSimdLevel();
+    for (int level = PhysicsKernels::SIMD_SCALAR; level <= best; level++) {
+        PhysicsKernels::setSimdLevel((PhysicsKernels::SimdLevel)level);
+        const char* name = PhysicsKernels::simdLevelName((PhysicsKernels::SimdLevel)level);
+
+        for (int kernel = 0; kernel < 2; kernel++) {
+            PhysicsKernels::PairCounts counts = { 0, 0 };
+            size_t hits = 0;
+            auto t0 = std::chrono::steady_clock::now();
+            for (int k = 0; k < repeats; k++) {
+                int a = k % rows; // Cycle the tested body so its data is not a constant
+                hits += (kernel == 0)
+                    ? PhysicsKernels::overlapRange(store, parked.data(), a, 1, count, out.data(), counts)
+                    : PhysicsKernels::overlapList(store, parked.data(), a, ids.data(), ids.size(), out.data(), counts);
+            }
+            auto t1 = std::chrono::steady_clock::now();
+            double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+            double perCandidate = ns / ((double)repeats * opt.micro);
+            const char* kernelName = (kernel == 0) ? "range" : "list";
+            bool last = level == best && kernel == 1;
+
+            if (opt.json) {
+                std::printf("  {\"simd\": \"%s\", \"kernel\": \"%s\", \"candidates\": %d, \"overlapping\": %.1f, "
+                            "\"ns_per_candidate\": %.3f}%s\n",
+                            name, kernelName, opt.micro, (double)hits / repeats, perCandidate, last ? "" : ",");
+            } else {
+                std::printf("%s,%s,%d,%.1f,%.3f\n", name, kernelName, opt.micro, (double)hits / repeats, perCandidate);
+            }
+        }
+    }
+    if (opt.json) std::printf("]\n");
+}
+
+void printRow(const Options& opt, const Result& r, bool last) {
+    const char* broadphase = (opt.broadphase == BROADPHASE_SPATIAL_HASH) ? "hash" : "brute";
+    const char* simd = PhysicsKernels::simdLevelName(PhysicsKernels::getSimdLevel());
+
+    if (opt.json) {
+        std::printf("  {\"bodies\": %d, \"trees\": %d, \"threads\": %d, \"worlds\": %d, "
+                    "\"broadphase\": \"%s\", \"simd\": \"%s\", \"steps\": %d, \"ns_per_step\": %.0f, "
+                    "\"p50_ns\": %.0f, \"p99_ns\": %.0f, \"world_steps_per_sec\": %.1f, "
+                    "\"pairs_tested\": %.1f, \"pairs_rejected\": %.1f, \"pairs_colliding\": %.1f, "
+                    "\"islands\": %.1f, \"solver_iterations\": %.1f, \"sleeping\": %.1f, "
+                    "\"lod_full\": %.1f, \"lod_half\": %.1f, \"lod_quarter\": %.1f, \"disorder\": %.3f, "
+                    "\"spatial_sorts\": %.0f, \"ns_per_ray\": %.1f, "
+                    "\"state_hash\": \"%016llx\"}%s\n",
+                    r.bodies, r.trees, r.threads, r.worlds, broadphase, simd, r.steps, r.nsPerStep, r.p50,
+                    r.p99, r.worldStepsPerSec, r.pairsTested, r.pairsRejected, r.pairsColliding, r.islands,
+                    r.solverIterations, r.sleeping, r.lodBodies[LOD_FULL], r.lodBodies[LOD_HALF],
+                    r.lodBodies[LOD_QUARTER], r.disorder, r.spatialSorts, r.nsPerRay, (unsigned long long)r.stateHash,
+                    last ? "" : ",");
+    } else {
+        std::printf("%d,%d,%d,%d,%s,%s,%d,%.0f,%.0f,%.0f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.3f,%.0f,"
+                    "%.1f,%016llx\n",
+                    r.bodies, r.trees, r.threads, r.worlds, broadphase, simd, r.steps, r.nsPerStep, r.p50,
+                    r.p99, r.worldStepsPerSec, r.pairsTested, r.pairsRejected, r.pairsColliding, r.islands,
+                    r.solverIterations, r.sleeping, r.lodBodies[LOD_FULL], r.lodBodies[LOD_HALF],
+                    r.lodBodies[LOD_QUARTER], r.disorder, r.spatialSorts, r.nsPerRay, (unsigned long long)r.stateHash);
+    }
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) return 1;
+    if (opt.micro > 0) {
+        runMicro(opt);
+        return 0;
+    }
+    if (opt.simd >= 0) PhysicsKernels::setSimdLevel((PhysicsKernels::SimdLevel)opt.simd);
+
+    if (opt.json) {
+        std::printf("[\n");
+    } else {
+        std::printf("bodies,trees,threads,worlds,broadphase,simd,steps,ns_per_step,p50_ns,p99_ns,"
+                    "world_steps_per_sec,pairs_tested,pairs_rejected,pairs_colliding,islands,solver_iterations,sleeping,"
+                    "lod_full,lod_half,lod_quarter,disorder,spatial_sorts,ns_per_ray,state_hash\n");
+    }
+
+    if (!opt.replayPath.empty()) {
+        Result r;
+        if (!replay(opt, r)) return 1;
+        printRow(opt, r, true);
+    } else {
+        for (size_t k = 0; k < opt.bodyCounts.size(); k++) {
+            int bodies = opt.bodyCounts[k];
+            Result r = (opt.worlds > 1) ? runBatch(opt, bodies) : run(opt, bodies);
+            printRow(opt, r, k + 1 == opt.bodyCounts.size());
+        }
+    }
+
+    if (opt.json) std::printf("]\n");
+    return 0;
+}
@@ -33,6 +33,8 @@ private:
     GtkWidget* back_button;
     GtkWidget* hide_trees_check;
     GtkWidget* tree_count_spin;
+    GtkWidget* spatial_hash_check;
+    GtkWidget* physics_rate_spin;
     
     // Simulation Box
     GtkWidget* sim_vbox;
@@ -53,13 +55,15 @@ private:
     static void on_back_clicked(GtkWidget* widget, gpointer data);
     static void on_hide_trees_toggled(GtkToggleButton* widget, gpointer data);
     static void on_tree_count_changed(GtkSpinButton* widget, gpointer data);
+    static void on_spatial_hash_toggled(GtkToggleButton* widget, gpointer data);
+    static void on_physics_rate_changed(GtkSpinButton* widget, gpointer data);
     static void on_button_clicked(GtkWidget* widget, gpointer data);
     
     // GL Callbacks
     static void on_realize(GtkGLArea* area, gpointer data);
     static gboolean on_render(GtkGLArea* area, GdkGLContext* context, gpointer data);
     static gboolean on_resize(GtkGLArea* area, gint width, gint height, gpointer data);
-    static gboolean on_tick(gpointer data);
+    static gboolean on_tick(GtkWidget* widget, GdkFrameClock* clock, gpointer data);
 
     bool is_simulation_running = false;
 };
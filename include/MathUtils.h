@@ -5,6 +5,7 @@
 #include <cstring>
 #include <iostream>
 #include <GL/gl.h>
+#include "Vector3.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -67,24 +68,6 @@ namespace MathGL {
     }
 }
 
-struct Vector3 {
-    float x, y, z;
-    
-    Vector3(float _x = 0, float _y = 0, float _z = 0) : x(_x), y(_y), z(_z) {}
-    
-    Vector3 operator+(const Vector3& other) const { return Vector3(x + other.x, y + other.y, z + other.z); }
-    Vector3 operator-(const Vector3& other) const { return Vector3(x - other.x, y - other.y, z - other.z); }
-    Vector3 operator*(float scalar) const { return Vector3(x * scalar, y * scalar, z * scalar); }
-    
-    float length() const { return std::sqrt(x * x + y * y + z * z); }
-    
-    Vector3 normalize() const {
-        float len = length();
-        if (len > 0) return *this * (1.0f / len);
-        return *this;
-    }
-};
-
 struct Matrix4 {
     float m[16];
 
@@ -115,6 +98,47 @@ struct Matrix4 {
     const float* data() const { return m; }
 };
 
+// The six clip planes of a projection * modelview matrix (column-major, as
+// glGetFloatv returns them), in the space the modelview maps from.
+// Planes are a*x + b*y + c*z + d >= 0 on the inside and are not normalized.
+struct Frustum {
+    float planes[6][4];
+
+    static Frustum fromMatrices(const float projection[16], const float modelview[16]) {
+        // clip = projection * modelview; row r of clip is m[r], m[r + 4], ...
+        float clip[16];
+        for (int c = 0; c < 4; c++) {
+            for (int r = 0; r < 4; r++) {
+                clip[c * 4 + r] = projection[r] * modelview[c * 4] + projection[r + 4] * modelview[c * 4 + 1] +
+                                  projection[r + 8] * modelview[c * 4 + 2] + projection[r + 12] * modelview[c * 4 + 3];
+            }
+        }
+        // Left, right, bottom, top, near, far: row 3 plus or minus rows 0, 1, 2
+        Frustum f;
+        for (int p = 0; p < 6; p++) {
+            int row = p / 2;
+            float sign = (p % 2 == 0) ? 1.0f : -1.0f;
+            for (int k = 0; k < 4; k++) {
+                f.planes[p][k] = clip[k * 4 + 3] + sign * clip[k * 4 + row];
+            }
+        }
+        return f;
+    }
+
+    // False only if the box is entirely outside one of the planes
+    bool intersectsAABB(float minX, float minY, float minZ, float maxX, float maxY, float maxZ) const {
+        for (int p = 0; p < 6; p++) {
+            const float* n = planes[p];
+            // The corner furthest along the plane normal
+            float x = (n[0] >= 0.0f) ? maxX : minX;
+            float y = (n[1] >= 0.0f) ? maxY : minY;
+            float z = (n[2] >= 0.0f) ? maxZ : minZ;
+            if (n[0] * x + n[1] * y + n[2] * z + n[3] < 0.0f) return false;
+        }
+        return true;
+    }
+};
+
 // Unproject screen coordinates to world coordinates on a horizontal plane (Y=planeY).
 // screenX, screenY are normalized [0,1] (top-left origin).
 // Returns the world XZ position where the ray hits the plane.
@@ -0,0 +1,67 @@
+#ifndef BODY_BVH_H
+#define BODY_BVH_H
+
+#include <vector>
+#include <cstdint>
+#include "Physics/PhysicsBodyStore.h"
+#include "Physics/PhysicsKernels.h"
+
+// Bounding volume hierarchy over the body AABBs, for scene queries.
+// Built top-down by median splits along the widest axis, then refit in
+// place as bodies move: leaves recompute their bounds from the position
+// columns and inner nodes merge their children, bottom-up. Refitting
+// keeps the topology, so the tree loosens as bodies drift apart; refit()
+// reports when it has loosened enough to be worth a rebuild.
+//
+// Ids are dense body indices. Queries only report bodies whose category
+// shares a bit with 'layerMask'. Among hits at exactly the same distance
+// the lowest id wins, so results do not depend on traversal order.
+class BodyBVH {
+public:
+    BodyBVH();
+
+    void build(const PhysicsBodyStore& bodies);
+    bool isBuilt() const { return !nodes.empty(); }
+
+    // False once the refit tree has grown well past its built quality
+    bool refit(const PhysicsBodyStore& bodies);
+
+    // Nearest body whose box, grown by 'expand' on each side, the ray
+    // (origin, 1 / direction) enters no later than maxT. Returns the id
+    // and writes the entry distance to outT, or returns -1.
+    int raycast(const PhysicsBodyStore& bodies, const float origin[3], const float invDir[3],
+                const float expand[3], float maxT, uint32_t layerMask, float& outT) const;
+
+    // Same for a packet of rays traversed together. Lanes set in
+    // 'activeLanes' search up to tBest[k] and, on a hit, update tBest[k]
+    // and hitId[k] (initialized by the caller, -1 for no hit).
+    void raycastPacket(const PhysicsBodyStore& bodies, const PhysicsKernels::RayPacket& rays,
+                       uint32_t activeLanes, uint32_t layerMask, float* tBest, int* hitId) const;
+
+    // Appends every body whose box overlaps [bmin, bmax]
+    void overlap(const PhysicsBodyStore& bodies, const float bmin[3], const float bmax[3],
+                 uint32_t layerMask, std::vector<int>& out) const;
+
+private:
+    struct Node {
+        float bmin[3];
+        float bmax[3];
+        uint32_t first; // Leaf: first entry in 'order'. Inner: right child; the left child is the next node.
+        uint32_t count; // Bodies in a leaf, 0 for an inner node
+    };
+
+    static const uint32_t LEAF_SIZE = 4;
+    static const int STACK_SIZE = 64;
+
+    std::vector<Node> nodes; // Depth-first, parents before children
+    std::vector<int> order;  // Body ids grouped by leaf
+    std::vector<float> centers; // Build scratch, 3 per body
+    float builtArea;         // Summed inner node area right after build()
+
+    uint32_t buildNode(const PhysicsBodyStore& bodies, uint32_t begin, uint32_t end);
+    void bodyBounds(const PhysicsBodyStore& bodies, int id, float bmin[3], float bmax[3]) const;
+    void leafBounds(const PhysicsBodyStore& bodies, Node& node) const;
+    float innerArea() const;
+};
+
+#endif // BODY_BVH_H
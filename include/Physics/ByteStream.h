@@ -0,0 +1,61 @@
+#ifndef BYTE_STREAM_H
+#define BYTE_STREAM_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// Little helpers for the physics binary formats (snapshots, recordings).
+// Values are written in host byte order; files are meant to be replayed
+// on the same kind of machine they were recorded on.
+struct ByteWriter {
+    std::vector<uint8_t>& out;
+
+    explicit ByteWriter(std::vector<uint8_t>& buffer) : out(buffer) {}
+
+    void bytes(const void* data, size_t size) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), p, p + size);
+    }
+
+    template <typename T>
+    void value(const T& v) { bytes(&v, sizeof(T)); }
+
+    template <typename T>
+    void array(const std::vector<T>& v) { bytes(v.data(), v.size() * sizeof(T)); }
+};
+
+// Reads back what ByteWriter wrote. Any read past the end fails and
+// leaves the reader in the failed state; callers check ok() once.
+struct ByteReader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    bool failed;
+
+    ByteReader(const uint8_t* d, size_t n) : data(d), size(n), pos(0), failed(false) {}
+
+    bool ok() const { return !failed; }
+    bool atEnd() const { return pos == size; }
+
+    bool bytes(void* dst, size_t n) {
+        if (failed || n > size - pos) {
+            failed = true;
+            return false;
+        }
+        if (n == 0) return true;
+        std::memcpy(dst, data + pos, n);
+        pos += n;
+        return true;
+    }
+
+    template <typename T>
+    bool value(T& v) { return bytes(&v, sizeof(T)); }
+
+    // Fills an already sized vector
+    template <typename T>
+    bool array(std::vector<T>& v) { return bytes(v.data(), v.size() * sizeof(T)); }
+};
+
+#endif // BYTE_STREAM_H
@@ -0,0 +1,29 @@
+#ifndef NARROWPHASE_H
+#define NARROWPHASE_H
+
+#include <cstdint>
+
+// Collision geometry of a body, fitted inside its AABB half-extents.
+// Bodies do not rotate, so round shapes always stand along world Y.
+enum CollisionShape {
+    COLLISION_BOX,      // The AABB itself
+    COLLISION_SPHERE,   // Radius = smallest half-extent
+    COLLISION_CYLINDER, // Radius = min(x, z) half-extent, half-height = y
+    COLLISION_CONE      // Base of the cylinder's radius at the bottom, apex at the top
+};
+
+// Exact overlap tests run after the AABB test has passed
+namespace Narrowphase {
+
+    struct Collider {
+        uint32_t shape; // CollisionShape
+        float center[3];
+        float half[3];  // AABB half-extents
+    };
+
+    // True if the two shapes overlap. Sphere, box and cylinder pairs use
+    // closed-form tests; pairs with a cone run GJK on the convex hulls.
+    bool intersect(const Collider& a, const Collider& b);
+}
+
+#endif // NARROWPHASE_H
@@ -0,0 +1,118 @@
+#ifndef PHYSICS_BODY_STORE_H
+#define PHYSICS_BODY_STORE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Stable reference to a body inside PhysicsEngine. The dense storage
+// index of a body moves as other bodies are removed; the handle does not.
+// Slots are recycled, so each reuse bumps the slot's generation and any
+// handle still carrying the old generation is detected as stale.
+struct PhysicsHandle {
+    static const uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+    uint32_t index;      // Slot in the engine's handle table
+    uint32_t generation; // Must match the slot's current generation
+
+    PhysicsHandle() : index(INVALID_INDEX), generation(0) {}
+    PhysicsHandle(uint32_t i, uint32_t g) : index(i), generation(g) {}
+
+    bool operator==(const PhysicsHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const PhysicsHandle& other) const { return !(*this == other); }
+};
+
+// Structure-of-arrays body storage. Every per-body attribute lives in its
+// own contiguous column so the integration kernels can stream through
+// them with SIMD loads instead of chasing one pointer per body.
+struct PhysicsBodyStore {
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> velX, velY, velZ;
+    std::vector<float> accX, accY, accZ;
+    std::vector<float> sizeX, sizeY, sizeZ; // Half-extents for AABB
+    std::vector<float> mass;
+    std::vector<float> friction;
+    std::vector<float> restitution;
+    std::vector<uint32_t> shape;    // CollisionShape, fitted inside the AABB
+    std::vector<uint32_t> category; // Collision layers the body is in, one bit each
+    std::vector<uint32_t> mask;     // Layers the body collides with
+    std::vector<uint32_t> isStatic; // 0 or ~0u, so SIMD code can use it as a lane mask
+    std::vector<uint32_t> isAsleep; // 0 or ~0u, same convention
+    std::vector<float> sleepTimer;  // Seconds spent below the sleep velocity
+    std::vector<float> groundImpulse; // Terrain contact impulse of the last solve, for warm starting
+    std::vector<uint32_t> lodBand;  // Update-rate band, 0 = every step
+    std::vector<float> lodElapsed;  // Seconds since the body was last integrated
+    std::vector<uint32_t> slots;    // Handle slot owning each dense entry
+
+    size_t size() const { return slots.size(); }
+
+    // Visit every column; new attributes only need to be listed here to be
+    // carried through resize/removal/snapshots by the helpers below.
+    template <typename F>
+    void forEachColumn(F&& f) { visitColumns(f, *this); }
+    template <typename F>
+    void forEachColumn(F&& f) const { visitColumns(f, *this); }
+
+    void resize(size_t n) {
+        forEachColumn([n](auto& col) { col.resize(n); });
+    }
+
+    // O(1) removal: the last entry is moved into 'index'
+    void swapRemove(size_t index) {
+        forEachColumn([index](auto& col) {
+            col[index] = col.back();
+            col.pop_back();
+        });
+    }
+
+    // Fill out so that its entry i is this store's entry order[i]; out keeps
+    // its capacity, so a caller reusing it across sorts does not allocate
+    void permuteInto(PhysicsBodyStore& out, const std::vector<uint32_t>& order) const {
+        auto gather = [&order](const auto& src, auto& dst) {
+            dst.resize(order.size());
+            for (size_t i = 0; i < order.size(); i++) dst[i] = src[order[i]];
+        };
+        visitColumns(gather, *this, out);
+    }
+
+    // Drop every entry whose flag is set, keeping the order of the rest
+    void compact(const std::vector<uint8_t>& removed) {
+        forEachColumn([&removed](auto& col) {
+            size_t out = 0;
+            for (size_t i = 0; i < col.size(); i++) {
+                if (!removed[i]) col[out++] = col[i];
+            }
+            col.resize(out);
+        });
+    }
+
+    void clear() {
+        forEachColumn([](auto& col) { col.clear(); });
+    }
+
+private:
+    template <typename F, typename... Stores>
+    static void visitColumns(F& f, Stores&... s) {
+        f(s.posX...); f(s.posY...); f(s.posZ...);
+        f(s.velX...); f(s.velY...); f(s.velZ...);
+        f(s.accX...); f(s.accY...); f(s.accZ...);
+        f(s.sizeX...); f(s.sizeY...); f(s.sizeZ...);
+        f(s.mass...);
+        f(s.friction...);
+        f(s.restitution...);
+        f(s.shape...);
+        f(s.category...);
+        f(s.mask...);
+        f(s.isStatic...);
+        f(s.isAsleep...);
+        f(s.sleepTimer...);
+        f(s.groundImpulse...);
+        f(s.lodBand...);
+        f(s.lodElapsed...);
+        f(s.slots...);
+    }
+};
+
+#endif // PHYSICS_BODY_STORE_H
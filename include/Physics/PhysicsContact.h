@@ -0,0 +1,40 @@
+#ifndef PHYSICS_CONTACT_H
+#define PHYSICS_CONTACT_H
+
+#include <cstddef>
+#include "Vector3.h"
+#include "Physics/PhysicsBodyStore.h"
+
+enum ContactState {
+    CONTACT_BEGIN,   // Bodies started touching this step
+    CONTACT_PERSIST, // Still touching (or resting together asleep)
+    CONTACT_END      // Touched last step, not any more; data is from last step
+};
+
+// One body-body contact, measured before the step resolved it
+struct PhysicsContact {
+    PhysicsHandle a, b;       // a has the lower handle index
+    Vector3 normal;           // Axis of least penetration, pointing from a to b
+    float penetration;        // Overlap along 'normal'
+    Vector3 relativeVelocity; // Velocity of b minus velocity of a
+    ContactState state;
+};
+
+// Read-only view over contiguous contacts, in the style of std::span
+class ContactView {
+public:
+    ContactView() : first(nullptr), count(0) {}
+    ContactView(const PhysicsContact* data, size_t size) : first(data), count(size) {}
+
+    const PhysicsContact* begin() const { return first; }
+    const PhysicsContact* end() const { return first + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const PhysicsContact& operator[](size_t i) const { return first[i]; }
+
+private:
+    const PhysicsContact* first;
+    size_t count;
+};
+
+#endif // PHYSICS_CONTACT_H
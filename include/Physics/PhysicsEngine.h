@@ -4,44 +4,443 @@
 #include <vector>
 #include <map>
 #include <functional>
-#include "MathUtils.h"
+#include "Vector3.h"
+#include "Physics/PhysicsBodyStore.h"
+#include "Physics/BodyBVH.h"
+#include "Physics/PhysicsContact.h"
+#include "Physics/Narrowphase.h"
+#include "Physics/SpatialHash.h"
+#include "Physics/WorkerPool.h"
 
+class PhysicsRecorder;
+
+// Body description used to create bodies and to read one back in a piece.
+// The engine itself stores bodies as structure-of-arrays (PhysicsBodyStore).
 struct PhysicsObject {
     Vector3 position;
     Vector3 velocity;
     Vector3 acceleration;
     float mass;
     float friction; // 0.0 to 1.0, where 1.0 is high friction
+    float restitution; // Bounciness of contacts: 0.0 stops dead, 1.0 is elastic
     bool isStatic;
     Vector3 size; // Half-extents for AABB (x, y, z)
+    CollisionShape shape; // Exact shape inside the AABB, for the narrowphase
+
+    // Collision layers: two bodies collide only if each one's category
+    // shares a bit with the other's mask
+    uint32_t collisionCategory;
+    uint32_t collisionMask;
+
+    PhysicsObject()
+        : position(0,0,0), velocity(0,0,0), acceleration(0,0,0),
+          mass(1.0f), friction(5.0f), restitution(0.0f), isStatic(false), size(0.5f, 0.5f, 0.5f),
+          shape(COLLISION_BOX), collisionCategory(1u), collisionMask(~0u) {}
+};
+
+// Candidate pair generation for object vs object collisions
+enum BroadphaseMode {
+    BROADPHASE_BRUTE_FORCE,  // Every pair, O(n^2)
+    BROADPHASE_SPATIAL_HASH  // Only pairs sharing a grid cell
+};
+
+// Ray for batched queries. The direction need not be normalized.
+struct PhysicsRay {
+    Vector3 origin;
+    Vector3 direction;
+    float maxDistance;
+
+    PhysicsRay() : maxDistance(1e30f) {}
+    PhysicsRay(const Vector3& o, const Vector3& d, float maxDist = 1e30f) : origin(o), direction(d), maxDistance(maxDist) {}
+};
+
+// Result of a ray or sweep query
+struct RaycastHit {
+    PhysicsHandle body; // Invalid handle on a miss
+    float distance;     // Along the normalized direction
+    Vector3 point;      // Where the ray, or the centre of the swept box, stops
+    Vector3 normal;     // Face of 'body' that was hit; zero if the query started inside it
+
+    RaycastHit() : distance(0.0f) {}
+    bool hit() const { return body.index != PhysicsHandle::INVALID_INDEX; }
+};
+
+// How raycastBatch traverses the query tree
+enum RaycastMode {
+    RAYCAST_SINGLE, // One ray at a time
+    RAYCAST_PACKET  // Eight rays at a time with SIMD slab tests, for coherent rays
+};
+
+// Update-rate bands of the physics LOD, nearest first
+enum PhysicsLodBand {
+    LOD_FULL,    // Every step
+    LOD_HALF,    // Every 2nd step
+    LOD_QUARTER, // Every 4th step
+    LOD_BAND_COUNT
+};
+
+// Counters from the most recent step, for benchmarking
+struct PhysicsStats {
+    int pairsFiltered;  // Candidates dropped by collision layers, before any AABB test
+    int pairsTested;    // AABB tests performed
+    int pairsRejected;  // AABB overlaps the exact shape test turned down
+    int pairsColliding; // Contacts handed to the solver
+    int islands;        // Independent groups of touching dynamic bodies
+    int awakeBodies;    // Dynamic bodies being simulated
+    int sleepingBodies; // Dynamic bodies at rest, skipped until woken
+    int fastBodies;     // Bodies swept for continuous collision
+    int ccdClamps;      // Fast bodies stopped at a time of impact
+    int solverIterations; // Contact solver sweeps, summed over islands
+    int lodBodies[LOD_BAND_COUNT]; // Dynamic bodies in each LOD band
+    int lodParked;      // Awake bodies skipped this step by their band
+    float disorder;     // Fraction of bodies out of Morton order at the last check
+    int spatialSorts;   // Storage re-sorts done this step (0 or 1)
 
-    PhysicsObject() 
-        : position(0,0,0), velocity(0,0,0), acceleration(0,0,0), 
-          mass(1.0f), friction(5.0f), isStatic(false), size(0.5f, 0.5f, 0.5f) {}
+    PhysicsStats()
+        : pairsFiltered(0), pairsTested(0), pairsRejected(0), pairsColliding(0), islands(0), awakeBodies(0), sleepingBodies(0),
+          fastBodies(0), ccdClamps(0), solverIterations(0), lodBodies{ 0, 0, 0 }, lodParked(0),
+          disorder(0.0f), spatialSorts(0) {}
 };
 
 class PhysicsEngine {
 public:
-    PhysicsEngine();
+    // workerCount as for setWorkerCount; 0 is one per core, up to 8
+    explicit PhysicsEngine(int workerCount = 0);
     ~PhysicsEngine();
 
     void update(float dt);
-    
+
     // Register an object to be simulated
-    // Returns a pointer to the internal physics object so the Scene can sync with it
-    PhysicsObject* addObject(const Vector3& initialPos);
-    
-    // Remove object
-    void removeObject(PhysicsObject* obj);
+    // Returns a handle the Scene keeps to read and write the body
+    PhysicsHandle addObject(const Vector3& initialPos);
+    PhysicsHandle addObject(const PhysicsObject& desc);
+
+    // Remove object in O(1); stale or invalid handles are ignored
+    void removeObject(PhysicsHandle handle);
+
+    // Remove many bodies in one pass, keeping the order of the survivors
+    void removeObjects(const std::vector<PhysicsHandle>& handles);
+
+    // Remove every body; all outstanding handles become stale
+    void clear();
+
+    bool isValid(PhysicsHandle handle) const;
+    int getObjectCount() const { return (int)bodies.size(); }
+
+    // Per-body accessors. Reads of an invalid handle return defaults and
+    // writes are ignored. Changing position, velocity or acceleration
+    // wakes a sleeping body.
+    PhysicsObject getObject(PhysicsHandle handle) const;
+    Vector3 getPosition(PhysicsHandle handle) const;
+    Vector3 getVelocity(PhysicsHandle handle) const;
+    Vector3 getAcceleration(PhysicsHandle handle) const;
+    void setPosition(PhysicsHandle handle, const Vector3& position);
+    void setVelocity(PhysicsHandle handle, const Vector3& velocity);
+    void setAcceleration(PhysicsHandle handle, const Vector3& acceleration);
+    void setMass(PhysicsHandle handle, float mass);
+    void setFriction(PhysicsHandle handle, float friction);
+    void setRestitution(PhysicsHandle handle, float restitution);
+    void setStatic(PhysicsHandle handle, bool isStatic);
+    void setSize(PhysicsHandle handle, const Vector3& size);
+    void setShape(PhysicsHandle handle, CollisionShape shape);
+    void setCollisionFilter(PhysicsHandle handle, uint32_t category, uint32_t mask);
+
+    // Position of every handle slot, indexed by PhysicsHandle::index, and
+    // the slot's generation (0 for a free slot). One pass over the bodies,
+    // for publishing state to other threads.
+    void copySlotPositions(std::vector<Vector3>& positions, std::vector<uint32_t>& generations) const;
+
+    // Sleeping: a dynamic body whose speed stays below 'velocity' for
+    // 'time' seconds (with no input acceleration) stops being integrated
+    // and is skipped by pair tests against other resting bodies. It wakes
+    // on contact with an awake body or when its state is written.
+    void setSleepEnabled(bool enabled);
+    void setSleepThreshold(float velocity, float time);
+    bool isAsleep(PhysicsHandle handle) const;
+    void wakeObject(PhysicsHandle handle);
+
+    // Continuous collision: a body moving more than 'fraction' of its
+    // half-extent on any axis in one step is swept from its old to its
+    // new position and stopped just inside the first body it would hit,
+    // so the regular contact solver sees the hit instead of tunnelling.
+    void setCcdEnabled(bool enabled);
+    void setCcdThreshold(float fraction);
 
-    // Terrain height callback - set by Scene to enable terrain-aware collisions
-    std::function<float(float, float)> getTerrainHeight;
+    // Contact solver: sequential impulses along the contact normal with
+    // friction and restitution, warm started from the impulses of the
+    // previous step. Each island runs up to 'iterations' sweeps and stops
+    // early once no sweep changes a velocity by more than 'tolerance'.
+    void setSolverIterations(int iterations);
+    void setSolverTolerance(float tolerance);
+    int getSolverIterations() const { return solverIterations; }
+    float getSolverTolerance() const { return solverTolerance; }
+
+    // Physics LOD: dynamic bodies are banded by their distance to the
+    // nearest focus point. Bodies within 'near' step every update, up to
+    // 'far' every 2nd update and beyond that every 4th, each time over the
+    // time elapsed since their last step. A body only changes band once
+    // it is 'hysteresis' past the boundary, so bodies on an edge do not
+    // flicker between rates. A body not due this update is parked: it is
+    // not integrated and, like a sleeper, not tested against other
+    // resting bodies.
+    // Off, or with no focus points, every body steps every update.
+    void setLodEnabled(bool enabled);
+    void setLodFocus(const std::vector<Vector3>& points);
+    void setLodDistances(float nearDistance, float farDistance);
+    void setLodHysteresis(float margin);
+    bool isLodEnabled() const { return lodEnabled; }
+    const std::vector<Vector3>& getLodFocus() const { return lodFocus; }
+
+    // Spatial sort: bodies are kept in storage in the Z-order (Morton
+    // order) of their positions, so bodies close in the world are close
+    // in memory and the pair search and solver walk the columns in order
+    // instead of jumping around. Every 'interval' updates the engine
+    // measures the fraction of neighbouring bodies that are out of Morton
+    // order and re-sorts once it passes 'threshold'. Handles stay valid;
+    // results change with the order, but equally on every run.
+    void setSpatialSortEnabled(bool enabled);
+    void setSpatialSortPolicy(int interval, float threshold);
+    bool isSpatialSortEnabled() const { return spatialSortEnabled; }
+    void sortBodies(); // Re-sort now, whether enabled or not
+
+    // Scene queries against the body AABBs, through a bounding volume
+    // hierarchy that is refit to the moved bodies on the first query after
+    // a step and rebuilt after bodies are added or removed. Only bodies
+    // whose collision category shares a bit with 'layerMask' are reported.
+    // Ties between equally near bodies are broken the same way in every
+    // mode, so single and packet traversal return the same hits.
+    bool raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit,
+                 uint32_t layerMask = ~0u);
+    void raycastBatch(const PhysicsRay* rays, size_t count, RaycastHit* hits, uint32_t layerMask = ~0u);
+    // First body a box of 'halfExtents' centred on 'center' touches when
+    // moved up to 'maxDistance' along 'direction'
+    bool sweepAABB(const Vector3& center, const Vector3& halfExtents, const Vector3& direction,
+                   float maxDistance, RaycastHit& hit, uint32_t layerMask = ~0u);
+    // Every body whose AABB overlaps [min, max], touching included
+    void overlapAABB(const Vector3& min, const Vector3& max, std::vector<PhysicsHandle>& out,
+                     uint32_t layerMask = ~0u);
+    void setRaycastMode(RaycastMode mode) { raycastMode = mode; }
+    RaycastMode getRaycastMode() const { return raycastMode; }
+
+    // Broadphase selection, switchable at runtime
+    void setBroadphaseMode(BroadphaseMode mode) { broadphaseMode = mode; }
+    BroadphaseMode getBroadphaseMode() const { return broadphaseMode; }
+    void setCellSize(float size) { spatialHash.setCellSize(size); }
+
+    // Threads used by each phase of update(), including the caller.
+    // Results are identical for any count.
+    void setWorkerCount(int count);
+    int getWorkerCount() const;
+
+    const PhysicsStats& getStats() const { return stats; }
+
+    // Contact events of the most recent step: every touching body pair as
+    // BEGIN or PERSIST, plus an END for each pair that separated. Sorted by
+    // handle. The view stays valid until the next update(); the buffers
+    // behind it are reused, so steady-state steps do not allocate.
+    ContactView getContacts() const { return ContactView(contactEvents.data(), contactEvents.size()); }
+    void setContactsEnabled(bool enabled);
+
+    // Snapshots: every body column, the handle table and the settings that
+    // affect results, as a versioned binary blob (PhysicsSnapshot.cpp).
+    // Restoring reuses the existing storage and brings back the handles
+    // that were live when the snapshot was taken. A malformed blob is
+    // rejected and leaves the engine untouched.
+    void saveSnapshot(std::vector<uint8_t>& out) const;
+    // FNV-1a of saveSnapshot's bytes, continued from 'hash' so several
+    // worlds can be chained; equal hashes mean bit-identical states
+    uint64_t stateHash(uint64_t hash = 1469598103934665603ull) const;
+    bool restoreSnapshot(const uint8_t* data, size_t size);
+
+    // While set, every call that changes simulation state is logged to
+    // the recorder so the session can be replayed (see PhysicsRecorder)
+    void setRecorder(PhysicsRecorder* r) { recorder = r; }
+
+    // Terrain height callback - set by Scene to enable terrain-aware collisions.
+    // Batched: fills heights[k] for the points (x[k], z[k]), k < count. Called
+    // once per chunk of bodies, straight on the position columns.
+    std::function<void(const float* x, const float* z, float* heights, size_t count)> sampleTerrainHeights;
 
 private:
-    std::vector<PhysicsObject*> objects;
-    
-    void checkCollisions(float dt);
-    void resolveCollision(PhysicsObject* a, PhysicsObject* b);
+    PhysicsBodyStore bodies;
+
+    // Generational handle table. A live slot points at its dense index in
+    // 'bodies'; a free slot holds INVALID_INDEX and sits on freeSlots.
+    struct Slot {
+        uint32_t dense;
+        uint32_t generation;
+    };
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::vector<uint8_t> removedScratch; // Per-body flags for removeObjects
+
+    // restoreSnapshot reads the bodies and handle table here and swaps them
+    // in once they check out; after a swap they hold the previous state, so
+    // repeated restores reuse the storage
+    PhysicsBodyStore restoreBodies;
+    std::vector<Slot> restoreSlots;
+    std::vector<uint32_t> restoreFreeSlots;
+    std::vector<uint8_t> restoreSeen;
+
+    void releaseSlot(uint32_t slot);
+    bool restoredHandlesValid();
+
+    BroadphaseMode broadphaseMode;
+    SpatialHash spatialHash;
+    bool sleepEnabled;
+    float sleepVelocity;
+    float sleepTime;
+    bool ccdEnabled;
+    float ccdThreshold;
+    bool contactsEnabled;
+    int solverIterations;
+    float solverTolerance;
+    bool lodEnabled;
+    float lodNear;
+    float lodFar;
+    float lodHysteresis;
+    uint32_t lodStep; // Updates taken, picks which bands are due
+    std::vector<Vector3> lodFocus;
+    bool spatialSortEnabled;
+    int spatialSortInterval;
+    float spatialSortThreshold;
+    uint32_t spatialSortStep; // Updates since the last disorder check
+    std::vector<uint64_t> sortKeys; // Morton code << 32 | dense index
+    std::vector<uint32_t> sortOrder;
+    PhysicsBodyStore sortedBodies; // Sort target, swapped with bodies
+    PhysicsStats stats;
+    WorkerPool workerPool;
+
+    // Query tree state: current, bodies moved since the last refit, or
+    // bodies added or removed since the last build
+    enum QueryTreeState { QUERY_TREE_CURRENT, QUERY_TREE_MOVED, QUERY_TREE_STALE };
+    BodyBVH queryTree;
+    QueryTreeState queryTreeState;
+    RaycastMode raycastMode;
+    std::vector<int> queryScratch;
+    PhysicsRecorder* recorder;
+
+    // Bodies per parallelFor chunk in each phase
+    static const size_t INTEGRATE_CHUNK = 1024;
+    static const size_t PAIR_CHUNK = 128;
+    static const size_t ISLAND_CHUNK = 16;
+
+    struct ContactPair {
+        int a, b; // Dense indices, a < b
+        ContactPair() : a(0), b(0) {}
+        ContactPair(int i, int j) : a(i), b(j) {}
+    };
+
+    // Per-chunk output of the parallel pair search
+    struct PairChunk {
+        std::vector<ContactPair> pairs;
+        std::vector<int> candidates;
+        std::vector<int> overlapping; // Candidates of the current row that pass the AABB filter
+        int filtered;
+        int tested;
+        int rejected;
+    };
+    std::vector<PairChunk> pairChunks;
+    std::vector<ContactPair> pairs;
+
+    // Dense indices of the dynamic bodies, ascending, rebuilt every step.
+    // Static rows of the brute-force search only walk this list.
+    std::vector<int> dynamicBodies;
+
+    // Island partitioning scratch, reused every step
+    std::vector<int> islandParent;
+    std::vector<int> islandOfRoot;
+    std::vector<int> pairIsland;
+    std::vector<int> islandStart;  // Pairs of island k: islandPairs[islandStart[k] .. islandStart[k + 1])
+    std::vector<int> islandCursor;
+    std::vector<ContactPair> islandPairs;
+    std::vector<int> islandBodyStart; // Dynamic bodies of island k, same layout as islandStart
+    std::vector<int> islandBodies;
+    std::vector<int> islandIterations;
+    std::vector<float> groundHeights; // Terrain height under each body, per step
+    std::vector<float> bodyDt; // Time each body integrates this step
+    std::vector<uint32_t> lodParked; // 0 or ~0u: skipped this step by its LOD band (bodyDt = 0)
+    std::vector<int> chunkAwake; // Per-chunk counters of the sleep pass
+    std::vector<int> chunkSleeping;
+    std::vector<int> chunkLod; // Per-chunk band counts, LOD_BAND_COUNT + 1 (parked) each
+
+    // Bodies needing a swept test this step, with where they started
+    struct FastMover {
+        int body;
+        float startX, startY, startZ;
+    };
+    std::vector<std::vector<FastMover>> chunkFastMovers; // Per integrate chunk
+    std::vector<FastMover> fastMovers;
+    std::vector<int> ccdCandidates;
+
+    // Solver row for each entry of islandPairs
+    struct SolverContact {
+        int a, b;           // a has the lower handle index
+        int axis;           // Normal axis; the other two carry friction
+        float sign;         // Normal points from a to b along 'axis'
+        float invMassA, invMassB;
+        float effectiveMass;
+        float friction;
+        float bias;         // Target separating speed from restitution
+        float normalImpulse;
+        float tangentImpulse[2];
+    };
+    std::vector<SolverContact> solverContacts;
+
+    // Accumulated impulses of each contact, kept for warm starting the
+    // next step and sorted by body handles
+    struct CachedImpulse {
+        PhysicsHandle a, b;
+        int axis;
+        float sign;
+        float normal;
+        float tangent[2];
+    };
+    std::vector<CachedImpulse> impulseCache;
+    std::vector<CachedImpulse> impulseCacheNext;
+    static bool cacheKeyLess(const CachedImpulse& x, const CachedImpulse& y);
+
+    // Contact stream: this step's measured contacts, the touching set of
+    // the previous step and the merged result, all sorted by handle
+    std::vector<PhysicsContact> contactsFound;
+    std::vector<PhysicsContact> contactsPrevious;
+    std::vector<PhysicsContact> contactsActive;
+    std::vector<PhysicsContact> contactEvents;
+
+    // Dense index of a live handle, or -1
+    int indexOf(PhysicsHandle handle) const;
+
+    void assignLodBands(size_t begin, size_t end, float dt);
+    float computeSortKeys();
+    void applySortOrder();
+    void maintainSpatialSort();
+    void refreshQueryTree();
+    void markQueryTree(QueryTreeState state) { if (state > queryTreeState) queryTreeState = state; }
+    void fillHit(int body, const float origin[3], const float dir[3], const float expand[3], float t,
+                 RaycastHit& hit) const;
+    void collectFastMovers(size_t begin, size_t end);
+    void resolveGround(size_t begin, size_t end);
+    void wake(int i);
+    void wakeAll();
+    bool isInactive(int i) const { return (bodies.isStatic[i] | bodies.isAsleep[i] | lodParked[i]) != 0; }
+    bool layersCollide(int a, int b) const {
+        return (bodies.category[a] & bodies.mask[b]) != 0 && (bodies.category[b] & bodies.mask[a]) != 0;
+    }
+    void buildBroadphase();
+    void sweepFastMovers();
+    bool sweepHit(const FastMover& m, int target, float& toi) const;
+    void findPairs();
+    void wakeTouchedSleepers();
+    void measureContacts();
+    void classifyContacts();
+    bool shapesIntersect(int a, int b) const;
+    void acceptPair(int a, int b, PairChunk& chunk) const;
+    int findRoot(int i);
+    void buildIslands();
+    void solveIslands();
+    void solveIsland(int island);
+    void updateSleep();
+    int contactAxis(int a, int b, float& penetration, float& sign) const;
 };
 
 #endif // PHYSICS_ENGINE_H
@@ -0,0 +1,89 @@
+#ifndef PHYSICS_KERNELS_H
+#define PHYSICS_KERNELS_H
+
+#include <cstddef>
+#include "Physics/PhysicsBodyStore.h"
+
+// Vectorized inner loops of the physics step. Each kernel has an AVX2,
+// an SSE and a scalar implementation; all three produce bit-identical
+// results, and the widest one the CPU supports is picked at startup.
+namespace PhysicsKernels {
+
+    enum SimdLevel {
+        SIMD_SCALAR,
+        SIMD_SSE,
+        SIMD_AVX2
+    };
+
+    // Best level supported by this CPU
+    SimdLevel detectSimdLevel();
+
+    // Force a level (clamped to what the CPU supports), e.g. for benchmarking
+    void setSimdLevel(SimdLevel level);
+    SimdLevel getSimdLevel();
+    const char* simdLevelName(SimdLevel level);
+
+    // Gravity, user acceleration, speed clamp / friction damping and
+    // position integration for bodies [begin, end), body i over dt[i]
+    // seconds. Static and sleeping bodies, and bodies with dt[i] = 0, are
+    // untouched.
+    void integrate(PhysicsBodyStore& bodies, size_t begin, size_t end, const float* dt);
+
+    // Square heightfield of (res + 1) x (res + 1) samples, row-major in z,
+    // with sample (0, 0) at world (origin, origin)
+    struct Heightfield {
+        const float* heights;
+        int res;
+        float origin;
+        float cellSize;
+    };
+
+    // Bilinear height under each (x[k], z[k]) for k < count. Points off
+    // the field are clamped to its edge.
+    void sampleHeightfield(const Heightfield& field, const float* x, const float* z, float* out, size_t count);
+
+    // Broadphase pair filter: body 'a' against a run of candidates, in
+    // order. A pair is skipped if both bodies are inactive (static, asleep
+    // or flagged in 'parked'), counted in 'filtered' if their collision
+    // layers reject each other, and otherwise AABB-tested and counted in
+    // 'tested'. Candidates whose boxes overlap 'a' are written to 'out',
+    // which must have room for every candidate; returns how many.
+    struct PairCounts {
+        int filtered;
+        int tested;
+    };
+
+    // Candidates are the ids first .. end - 1, read straight from the columns
+    size_t overlapRange(const PhysicsBodyStore& bodies, const uint32_t* parked, int a, int first, int end,
+                        int* out, PairCounts& counts);
+
+    // Candidates are ids[0 .. count), gathered
+    size_t overlapList(const PhysicsBodyStore& bodies, const uint32_t* parked, int a, const int* ids, size_t count,
+                       int* out, PairCounts& counts);
+
+    // Rays for the slab tests below carry 1 / direction. Near-zero
+    // components are pushed out to +-1e8, so a ray parallel to a slab
+    // needs no special case: it is either inside it everywhere or never.
+    inline float inverseDirection(float d) {
+        const float MIN_COMPONENT = 1e-8f;
+        if (d > -MIN_COMPONENT && d < MIN_COMPONENT) d = (d < 0.0f) ? -MIN_COMPONENT : MIN_COMPONENT;
+        return 1.0f / d;
+    }
+
+    // Eight rays in structure-of-arrays form, traversed together
+    static const int RAY_PACKET_SIZE = 8;
+    struct RayPacket {
+        float originX[RAY_PACKET_SIZE], originY[RAY_PACKET_SIZE], originZ[RAY_PACKET_SIZE];
+        float invDirX[RAY_PACKET_SIZE], invDirY[RAY_PACKET_SIZE], invDirZ[RAY_PACKET_SIZE];
+    };
+
+    // Slab test of every packet ray against the box [bmin, bmax]: the
+    // vector form of rayIntersectsAABB. Lane k passes if its ray leaves
+    // the box at or after 0 and enters it no later than tMax[k]; tEntry[k]
+    // gets the entry distance, 0 for a ray starting inside. Returns the
+    // passing lanes as bits.
+    uint32_t slabTest(const RayPacket& rays, const float bmin[3], const float bmax[3], const float* tMax,
+                      float* tEntry);
+}
+
+#endif // PHYSICS_KERNELS_H
@@ -0,0 +1,88 @@
+#ifndef PHYSICS_RECORDER_H
+#define PHYSICS_RECORDER_H
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include "Vector3.h"
+#include "Physics/PhysicsBodyStore.h"
+
+class PhysicsEngine;
+struct PhysicsObject;
+
+// Records a physics session for deterministic replay: a snapshot of the
+// engine when recording starts, followed by every state-changing call
+// made on it (steps, bodies added or removed, input writes such as
+// setAcceleration). The engine step is deterministic, so replaying the
+// calls on the restored snapshot reproduces the session bit for bit.
+class PhysicsRecorder {
+public:
+    enum Event : uint8_t {
+        EVENT_STEP,
+        EVENT_ADD,
+        EVENT_REMOVE,
+        EVENT_REMOVE_MANY,
+        EVENT_CLEAR,
+        EVENT_SET_POSITION,
+        EVENT_SET_VELOCITY,
+        EVENT_SET_ACCELERATION,
+        EVENT_SET_SIZE,
+        EVENT_SET_MASS,
+        EVENT_SET_FRICTION,
+        EVENT_SET_STATIC,
+        EVENT_WAKE,
+        EVENT_SLEEP_ENABLED,
+        EVENT_SLEEP_THRESHOLD,
+        EVENT_CCD_ENABLED,
+        EVENT_CCD_THRESHOLD,
+        EVENT_SET_RESTITUTION,
+        EVENT_SOLVER_ITERATIONS,
+        EVENT_SOLVER_TOLERANCE,
+        EVENT_SET_SHAPE,
+        EVENT_SET_FILTER,
+        EVENT_LOD_ENABLED,
+        EVENT_LOD_DISTANCES,
+        EVENT_LOD_HYSTERESIS,
+        EVENT_LOD_FOCUS,
+        EVENT_SORT_ENABLED,
+        EVENT_SORT_POLICY,
+        EVENT_SORT_NOW
+    };
+
+    PhysicsRecorder();
+    ~PhysicsRecorder();
+
+    // Snapshot 'engine' and log everything done to it until stop()
+    void start(PhysicsEngine& engine);
+    void stop();
+    bool isRecording() const { return target != nullptr; }
+    int getStepCount() const { return steps; }
+
+    bool save(const char* path) const;
+    bool load(const char* path);
+
+    // Restore the starting snapshot into 'engine' and re-issue every
+    // recorded call. Steps go through 'step' when given (it must call
+    // engine.update(dt)), e.g. to time them; otherwise update() is called
+    // directly. Returns false if the recording is malformed.
+    bool replay(PhysicsEngine& engine, const std::function<void(float dt)>& step = nullptr) const;
+
+    // Called by PhysicsEngine while recording
+    void recordStep(float dt);
+    void recordAdd(const PhysicsObject& desc);
+    void recordRemove(const PhysicsHandle* handles, size_t count);
+    void recordClear();
+    void recordVector(Event event, PhysicsHandle handle, const Vector3& v);
+    void recordScalar(Event event, PhysicsHandle handle, float value);
+    void recordSetting(Event event, float a, float b = 0.0f);
+    void recordFilter(PhysicsHandle handle, uint32_t category, uint32_t mask);
+    void recordFocus(const Vector3* points, size_t count);
+
+private:
+    PhysicsEngine* target;
+    std::vector<uint8_t> snapshot;
+    std::vector<uint8_t> events;
+    int steps;
+};
+
+#endif // PHYSICS_RECORDER_H
@@ -0,0 +1,114 @@
+#ifndef PHYSICS_THREAD_H
+#define PHYSICS_THREAD_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include "Vector3.h"
+#include "Physics/PhysicsBodyStore.h"
+
+class PhysicsEngine;
+
+// Read-only body state published after a physics step. Indexed by handle
+// slot (PhysicsHandle::index) so lookups stay O(1) while bodies move
+// around in the engine's dense storage.
+struct PhysicsFrame {
+    uint64_t step;          // Steps simulated when this was published
+    float stepLength;       // Seconds of simulation per step
+    std::chrono::steady_clock::time_point time; // When the step finished
+
+    std::vector<Vector3> previous;     // Position one step earlier
+    std::vector<Vector3> current;      // Position after the step
+    std::vector<uint32_t> generations; // Generation of each slot, 0 = free
+
+    PhysicsFrame() : step(0), stepLength(1.0f / 60.0f) {}
+
+    // Position blended 'alpha' of the way from the previous to the
+    // current step. False if the handle is not in this frame.
+    bool getPosition(PhysicsHandle handle, float alpha, Vector3& out) const;
+
+    // How far the step after this one has progressed, in [0, 1]
+    float alphaAt(std::chrono::steady_clock::time_point now) const;
+};
+
+// Runs a PhysicsEngine on its own thread at a fixed rate. Each step is
+// published through a triple buffer: the physics thread fills a back
+// frame and swaps it in with one atomic exchange, and the reader picks
+// up the newest frame with another, so neither side ever waits.
+//
+// Writes from other threads go through enqueue() and are applied between
+// steps. withEngine() is for the rare structural change (adding bodies)
+// whose result is needed right away; it waits for the current step.
+class PhysicsThread {
+public:
+    explicit PhysicsThread(PhysicsEngine& engine);
+    ~PhysicsThread();
+
+    void start();
+    void stop();
+    bool isRunning() const { return thread.joinable(); }
+
+    // Paused threads still apply commands and publish, but do not step
+    void setPaused(bool paused);
+    void setRate(float hz);
+    float getRate() const { return 1.0f / stepLength.load(); }
+    void setMaxSubsteps(int steps);
+
+    // Queue a change; applied on the physics thread before the next step
+    void enqueue(std::function<void(PhysicsEngine&)> command);
+
+    // Run 'fn' with exclusive access to the engine, then publish
+    template <typename F>
+    auto withEngine(F&& fn) -> decltype(fn(std::declval<PhysicsEngine&>())) {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        struct PublishOnExit {
+            PhysicsThread* owner;
+            ~PublishOnExit() { owner->publish(false); }
+        } publisher = { this };
+        return fn(engine);
+    }
+
+    // Latest published frame. Single reader: the returned frame stays
+    // valid and unchanged until this is called again.
+    const PhysicsFrame& acquireFrame();
+
+private:
+    PhysicsEngine& engine;
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<bool> paused;
+    std::atomic<float> stepLength;
+    std::atomic<int> maxSubsteps;
+
+    std::mutex engineMutex; // Held while stepping or inside withEngine
+    std::mutex queueMutex;
+    std::vector<std::function<void(PhysicsEngine&)>> commands;
+    std::vector<std::function<void(PhysicsEngine&)>> pending; // Drained on the physics thread
+
+    // Triple buffer: 'back' belongs to the writer, 'front' to the reader,
+    // and 'middle' holds the index of the third plus a fresh flag
+    static const uint32_t FRESH = 4;
+    PhysicsFrame frames[3];
+    uint32_t back;
+    uint32_t front;
+    std::atomic<uint32_t> middle;
+
+    // Writer-side history for interpolation: positions at the last
+    // publish and at the start of the latest step, with slot generations
+    std::vector<Vector3> lastPositions;
+    std::vector<uint32_t> lastGenerations;
+    std::vector<Vector3> stepStart;
+    std::vector<uint32_t> stepStartGenerations;
+    uint64_t lastStep;
+    std::chrono::steady_clock::time_point lastStepTime;
+
+    void run();
+    void applyCommands();
+    void publish(bool stepped);
+};
+
+#endif // PHYSICS_THREAD_H
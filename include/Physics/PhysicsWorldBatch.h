@@ -0,0 +1,59 @@
+#ifndef PHYSICS_WORLD_BATCH_H
+#define PHYSICS_WORLD_BATCH_H
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include "Physics/PhysicsEngine.h"
+#include "Physics/WorkerPool.h"
+
+// Many independent PhysicsEngine worlds stepped together, for offline
+// sweeps over layouts and seeds. Parallelism is across worlds: each world
+// steps on a single thread, and the batch spreads worlds over its pool, so
+// a node's cores stay busy without one process per world.
+//
+// Every world samples the same terrain callback, so they share one
+// read-only heightmap instead of holding a copy each.
+class PhysicsWorldBatch {
+public:
+    typedef std::function<void(const float* x, const float* z, float* heights, size_t count)> HeightSampler;
+
+    // 0 threads = one per core
+    explicit PhysicsWorldBatch(int threadCount = 0);
+    ~PhysicsWorldBatch();
+
+    // New empty world using the batch terrain. The reference stays valid
+    // until clear(); populate it before stepping.
+    PhysicsEngine& addWorld();
+    PhysicsEngine& getWorld(int index) { return *worlds[index]; }
+    const PhysicsEngine& getWorld(int index) const { return *worlds[index]; }
+    int getWorldCount() const { return (int)worlds.size(); }
+    void clear();
+
+    // Terrain for every world, current and future. Called concurrently
+    // from all batch threads, so it must only read shared data.
+    void setTerrain(HeightSampler sampler);
+
+    void setThreadCount(int count);
+    int getThreadCount() const { return pool.getThreadCount(); }
+
+    // Advance every world by 'steps' steps of 'dt'. A world runs all of
+    // its steps in one go to keep its data in cache. Each world's result
+    // is the same as stepping it alone.
+    void step(float dt, int steps = 1);
+
+    // Throughput of the most recent step() call, in world-steps per second
+    double getWorldStepsPerSecond() const { return lastWorldStepsPerSecond; }
+    uint64_t getTotalWorldSteps() const { return totalWorldSteps; }
+
+private:
+    std::vector<std::unique_ptr<PhysicsEngine>> worlds;
+    WorkerPool pool;
+    HeightSampler terrain;
+    double lastWorldStepsPerSecond;
+    uint64_t totalWorldSteps;
+};
+
+#endif // PHYSICS_WORLD_BATCH_H
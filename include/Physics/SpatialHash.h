@@ -0,0 +1,59 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include <vector>
+#include <cstdint>
+
+// Uniform grid over the XZ plane, stored as a hashed bucket table.
+// Bodies are inserted into every cell their footprint overlaps. A pair
+// sharing several cells is only reported from the lowest shared cell,
+// so every candidate pair comes out exactly once. Bodies inserted as
+// static are never reported to each other. A footprint too large for the
+// grid (or not finite) is kept out of it and paired with every body
+// instead, so one runaway body cannot blow up the cell count.
+class SpatialHash {
+public:
+    explicit SpatialHash(float cellSize = 2.0f);
+
+    void setCellSize(float size);
+    float getCellSize() const { return cellSize; }
+
+    // Rebuild the grid from scratch. Body ids are 0..count-1.
+    void clear(int count);
+    void insert(int id, float minX, float minZ, float maxX, float maxZ, bool isStatic = false);
+    void build();
+
+    // Appends every id j > id sharing a cell with 'id', in ascending order
+    void queryCandidates(int id, std::vector<int>& out) const;
+
+    // Same, but every other id regardless of order
+    void queryNeighbours(int id, std::vector<int>& out) const;
+
+private:
+    struct Entry {
+        int32_t cx, cz;
+        int id;
+        uint32_t isStatic;
+    };
+
+    float cellSize;
+    float invCellSize;
+
+    // Per-body cell range (inclusive)
+    std::vector<int32_t> cellMinX, cellMinZ, cellMaxX, cellMaxZ;
+    std::vector<uint8_t> staticIds;
+    std::vector<uint8_t> largeFlags; // Outside the grid, see insert()
+    std::vector<int> largeIds;       // Ascending, filled by build()
+
+    // Bucket table in CSR form: entries of bucket b live in
+    // entries[bucketStart[b] .. bucketStart[b + 1])
+    std::vector<uint32_t> bucketStart;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> cursor; // Scratch fill positions for build()
+    uint32_t bucketMask;
+
+    uint32_t bucketOf(int32_t cx, int32_t cz) const;
+    void query(int id, bool higherOnly, std::vector<int>& out) const;
+};
+
+#endif // SPATIAL_HASH_H
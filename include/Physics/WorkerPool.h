@@ -0,0 +1,53 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+// Small fork-join pool for the physics step. parallelFor() splits a range
+// into fixed-size chunks and blocks until every chunk has run; the calling
+// thread works on chunks too. Chunk boundaries depend only on the range and
+// chunk size, never on the thread count, so callers that write results per
+// chunk get the same output for any pool size.
+class WorkerPool {
+public:
+    typedef std::function<void(size_t begin, size_t end)> RangeFn;
+
+    explicit WorkerPool(int threadCount = 1);
+    ~WorkerPool();
+
+    // Total threads taking part in parallelFor, including the caller
+    void setThreadCount(int count);
+    int getThreadCount() const { return (int)workers.size() + 1; }
+
+    void parallelFor(size_t count, size_t chunkSize, const RangeFn& fn);
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeCv;
+    std::condition_variable doneCv;
+    bool stopping;
+
+    // Current job, published under 'mutex' by bumping jobId
+    uint64_t jobId;
+    const RangeFn* job;
+    size_t jobCount;
+    size_t jobChunkSize;
+    size_t jobChunks;
+    std::atomic<size_t> nextChunk;
+    int busyWorkers;
+
+    void startWorkers(int count);
+    void stopWorkers();
+    void workerLoop(uint64_t seenJob);
+    void runChunks();
+};
+
+#endif // WORKER_POOL_H
@@ -7,7 +7,10 @@
 #include "Terrain.h"
 #include "ShadowSystem.h"
 #include "Camera.h"
+#include "ShapeMeshes.h"
 #include "Physics/PhysicsEngine.h"
+#include "Physics/PhysicsRecorder.h"
+#include "Physics/PhysicsThread.h"
 #include <map>
 
 // Enum for Shape Type
@@ -18,11 +21,21 @@ enum ShapeType {
     SHAPE_CONE,
     SHAPE_TRICONE
 };
+const int SHAPE_TYPE_COUNT = SHAPE_TRICONE + 1;
+
+// Collision layers of the scene's physics bodies. A body's category is
+// bit (1 << layer); its mask is the set of layers it collides with.
+enum SceneLayer {
+    LAYER_TREES,
+    LAYER_SHAPES,
+    LAYER_LIGHT,  // Proxy body at the light, collides with nothing by default
+    LAYER_COUNT
+};
 
 // Abstract Base Class
 class Shape {
 public:
-    Vector3 position;
+    Vector3 position; // Where the shape is drawn
     Vector3 color;
     float size;
 
@@ -33,9 +46,6 @@ public:
     virtual void draw() const = 0;
     virtual void drawWireframe() const = 0;
     virtual ShapeType getType() const = 0;
-    
-    // Returns t if hit, or -1 if no hit. origin and dir are in world space.
-    virtual float intersect(const float origin[3], const float dir[3]) const = 0;
 };
 
 class Cube : public Shape {
@@ -44,7 +54,6 @@ public:
     void draw() const override;
     void drawWireframe() const override;
     ShapeType getType() const override { return SHAPE_CUBE; }
-    float intersect(const float origin[3], const float dir[3]) const override;
 };
 
 class Sphere : public Shape {
@@ -53,7 +62,6 @@ public:
     void draw() const override;
     void drawWireframe() const override;
     ShapeType getType() const override { return SHAPE_SPHERE; }
-    float intersect(const float origin[3], const float dir[3]) const override;
 };
 
 class Cylinder : public Shape {
@@ -62,7 +70,6 @@ public:
     void draw() const override;
     void drawWireframe() const override;
     ShapeType getType() const override { return SHAPE_CYLINDER; }
-    float intersect(const float origin[3], const float dir[3]) const override;
 };
 
 // Cone / Tricone (depending on segments)
@@ -74,7 +81,6 @@ public:
     void draw() const override;
     void drawWireframe() const override;
     ShapeType getType() const override { return (segments <= 3) ? SHAPE_TRICONE : SHAPE_CONE; }
-    float intersect(const float origin[3], const float dir[3]) const override;
 };
 
 class Scene {
@@ -83,8 +89,16 @@ public:
     ~Scene();
 
     void init();
-    void update(float dt);
+
+    // Physics runs on its own thread from init() on, at the physics rate.
+    // It starts paused; render() and pickObject() show its latest
+    // published step, blended towards the next one.
+    void setSimulationRunning(bool running);
     void render();
+
+    void setPhysicsRate(float hz);
+    float getPhysicsRate() const { return physicsThread->getRate(); }
+    void setMaxSubsteps(int steps) { physicsThread->setMaxSubsteps(steps); }
     void resize(int width, int height);
 
     void addShape(ShapeType type, float r, float g, float b);
@@ -92,6 +106,8 @@ public:
 
     // Terrain height query
     float getTerrainHeight(float x, float z) const;
+    // Chunks drawn and culled by the last frame's terrain render
+    TerrainRenderStats getTerrainStats() const;
 
     // Camera Control
     void rotateCamera(float dx, float dy);
@@ -112,14 +128,27 @@ public:
     // Move APIs
     void moveShape(int index, float x, float z);
     void moveSelectedShape(float dx, float dz); // Relative move
+    void setSelectedAcceleration(float ax, float az); // Input acceleration on XZ
     int  shapeCount() const;
     Vector3 getShapePosition(int index) const;
     ShapeType getShapeType(int index) const;
     void changeShapeType(int index, ShapeType newType);
 
-    // Physics Access
-    PhysicsEngine* getPhysicsEngine() const { return physicsEngine; }
-    PhysicsObject* getPhysicsObject(int index);
+    // Physics Access. Changes are queued for the physics thread.
+    PhysicsHandle getPhysicsHandle(int index) const;
+    void setBroadphaseMode(BroadphaseMode mode);
+
+    // Layers the bodies of 'layer' collide with, as (1 << SceneLayer) bits.
+    // A pair collides only if both layers accept each other.
+    void setLayerMask(SceneLayer layer, uint32_t mask);
+    uint32_t getLayerMask(SceneLayer layer) const { return layerMasks[layer]; }
+
+    // Record the physics session for replay in PhysicsBench. Stopping
+    // writes the recording to 'path' and returns the engine's stateHash
+    // at that point, which the replay's state_hash reproduces.
+    void startPhysicsRecording();
+    bool stopPhysicsRecording(const char* path, uint64_t& stateHash);
+    bool isPhysicsRecording() const { return physicsRecorder.isRecording(); }
     
     // Camera Access
     Camera* getCamera() const;
@@ -140,10 +169,26 @@ private:
     int selectedIndex;  // -1 = none
     
     PhysicsEngine* physicsEngine;
-    std::map<Shape*, PhysicsObject*> physicsMap;
+    PhysicsThread* physicsThread;
+    std::map<Shape*, PhysicsHandle> physicsMap;
+    PhysicsRecorder physicsRecorder;
+    PhysicsHandle lightBody;
+    uint32_t layerMasks[LAYER_COUNT];
+    Vector3 lodFocus; // Physics LOD focus last sent to the engine
     Terrain* terrain;
     ShadowSystem* shadowSystem;
 
+    void syncShapesFromPhysics();
+    void updateLodFocus();
+    void applyLayer(PhysicsObject& desc, SceneLayer layer) const;
+
+    // Per-frame instance lists for ShapeMeshes, one batch per shape type,
+    // re-uploaded only when their contents change
+    ShapeMeshes::InstanceBatch shapeInstances[SHAPE_TYPE_COUNT];
+    std::vector<ShapeMeshes::Instance> instanceScratch[SHAPE_TYPE_COUNT];
+    void updateInstances();
+    void drawOccluders(); // Shapes and trees, for the main pass and the shadow stencil
+
     void drawFloor();
     void drawWall();
     void drawLightWireframe(const Vector3& pos, float size);
@@ -155,10 +200,13 @@ private:
     struct Tree {
         Vector3 position;
         float size;
-        PhysicsObject* physObj;
+        PhysicsHandle body;
     };
     std::vector<Tree> trees;
+    ShapeMeshes::StaticBatch forestBatch; // Two parts per tree: trunk, then leaves
     void generateTrees(int count);
+    void addTrees(PhysicsEngine& engine, int count);
+    void removeTrees(PhysicsEngine& engine, size_t keep);
     void drawTree(const Tree& tree);
     
     bool showTrees;
@@ -0,0 +1,115 @@
+#ifndef SHAPE_MESHES_H
+#define SHAPE_MESHES_H
+
+#include <vector>
+#include "Vector3.h"
+
+// Unit meshes of the scene shapes, built once and kept in GL vertex and
+// index buffers. Each mesh is its shape at size 1 centred on the origin,
+// with the same vertices and normals the immediate mode code emits, so a
+// draw is one translate, one uniform scale and one glDrawElements.
+// GL_NORMALIZE (enabled in Scene::init) renormalizes the scaled normals.
+//
+// Many copies of one mesh are drawn in a single call with hardware
+// instancing (ARB_instanced_arrays and ARB_draw_instanced): a small GLSL
+// 1.20 program places each instance and lights it like the fixed function
+// pipeline does with GL_LIGHT0 and GL_COLOR_MATERIAL. Without those
+// extensions the instances are drawn one by one instead.
+//
+// Geometry that never moves can instead be baked into a StaticBatch: every
+// copy already in world space with its color, drawn in one call.
+//
+// Built with SHAPE_IMMEDIATE_MODE defined (CMake option of the same name)
+// the shapes go back to glBegin/glEnd, and begin() and end() do nothing.
+namespace ShapeMeshes {
+
+    enum MeshKind {
+        MESH_CUBE,
+        MESH_SPHERE,      // 'segments' latitude and longitude bands
+        MESH_CYLINDER,    // 'segments' around
+        MESH_CONE,        // 'segments' around, 3 for the tricone
+        MESH_TREE_TRUNK,  // Scene tree of size 1, origin at the foot of the trunk
+        MESH_TREE_LEAVES
+    };
+
+    // Segment counts the scene's shapes and trees use
+    const int SPHERE_SEGMENTS = 20;
+    const int CYLINDER_SEGMENTS = 32;
+    const int CONE_SEGMENTS = 32;
+    const int TRICONE_SEGMENTS = 3;
+    const int TREE_SEGMENTS = 8;
+
+    // Builds and uploads the meshes every shape type uses and sets up
+    // instancing if the driver supports it. Needs a current GL context.
+    // Other segment counts are added on first use.
+    void init();
+    bool isInstancingAvailable();
+
+    // Draws mesh (kind, segments) scaled by 'size' at 'position'. Between
+    // begin() and end() the buffers stay bound across draws; outside a
+    // pair, draw() and drawInstances() bind and unbind them themselves.
+    void draw(MeshKind kind, int segments, const Vector3& position, float size, const Vector3& color);
+    void begin();
+    void end();
+
+    // Placement of one instance: mesh scaled by 'scale' at (x, y, z)
+    struct Instance {
+        float x, y, z, scale;
+        float r, g, b;
+    };
+
+    // Instances kept in a GL buffer between frames. update() compares
+    // against what was uploaded last and only re-uploads on a change.
+    class InstanceBatch {
+    public:
+        InstanceBatch();
+
+        // Returns true if the contents changed and were uploaded
+        bool update(const std::vector<Instance>& instances);
+        size_t size() const { return instances.size(); }
+
+    private:
+        friend void drawInstances(MeshKind kind, int segments, const InstanceBatch& batch, const Vector3& tint);
+
+        std::vector<Instance> instances;
+        unsigned int buffer; // GL buffer name, 0 until the first upload
+    };
+
+    // Draws every instance of 'batch' as mesh (kind, segments), its color
+    // multiplied by 'tint'
+    void drawInstances(MeshKind kind, int segments, const InstanceBatch& batch, const Vector3& tint);
+
+    // Copies of the unit meshes transformed into world space, in buffers of
+    // their own. Parts are only added or dropped at the end, and draw()
+    // uploads just what changed since the last draw, so growing or
+    // shrinking the batch does not re-send the rest. Building needs no GL
+    // context; draw() does, and must not be called between begin() and end().
+    class StaticBatch {
+    public:
+        StaticBatch();
+
+        // Appends mesh (kind, segments) scaled by 'size' at 'position' as one part
+        void append(MeshKind kind, int segments, const Vector3& position, float size, const Vector3& color);
+        // Keeps the first 'parts' parts
+        void truncate(size_t parts);
+        void clear() { truncate(0); }
+        size_t size() const { return partEnds.size(); }
+
+        void draw();
+
+    private:
+        struct PartEnd {
+            size_t vertices; // Floats in 'baked' up to the end of the part
+            size_t indices;
+        };
+
+        std::vector<float> baked; // Position, normal, color per vertex
+        std::vector<unsigned int> bakedIndices;
+        std::vector<PartEnd> partEnds;
+        size_t uploadedVertices, uploadedIndices; // Prefix already in the buffers
+        size_t vertexCapacity, indexCapacity;     // Buffer sizes
+        unsigned int vertexBuffer, indexBuffer;   // 0 until the first draw
+    };
+}
+
+#endif // SHAPE_MESHES_H
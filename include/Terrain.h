@@ -3,12 +3,21 @@
 
 #include <vector>
 #include <cmath>
-#include <GL/gl.h>
-#include "MathUtils.h"
+#include "Vector3.h"
+#include "Physics/PhysicsKernels.h"
 
 // Forward declaration
 class ShadowSystem;
 
+// Counters from the most recent Terrain::render
+struct TerrainRenderStats {
+    int chunksDrawn;
+    int chunksCulled; // Outside the view frustum
+    int drawCalls;    // Neighbouring visible chunks share one
+
+    TerrainRenderStats() : chunksDrawn(0), chunksCulled(0), drawCalls(0) {}
+};
+
 class Terrain {
 public:
     Terrain(float worldSize = 50.0f, int gridRes = 128);
@@ -17,21 +26,53 @@ public:
     // Validates terrain generation (flat)
     void generate(unsigned int seed = 42);
 
-    // Query terrain height at any world (x, z) position (always returns 0)
+    // Query terrain height at any world (x, z) position, bilinear over the heightmap
     float getHeight(float x, float z) const;
 
+    // Batched getHeight: out[k] = height at (x[k], z[k]) for k < count.
+    // Vectorized, for per-step queries over many bodies.
+    void sampleHeights(const float* x, const float* z, float* out, size_t count) const;
+
     // Get approximate normal at world (x, z) for lighting (always up)
     Vector3 getNormal(float x, float z) const;
 
-    // Render the terrain mesh
-    void render(GLuint textureId) const;
+    // Render the terrain mesh (TerrainRender.cpp, the only part needing GL).
+    // The mesh is built into a vertex and index buffer on the first render
+    // after generate() and drawn from there until the next generate().
+    // Chunks outside the frustum of the current projection and modelview
+    // matrices are skipped.
+    void render(unsigned int textureId);
+    const TerrainRenderStats& getRenderStats() const { return stats; }
 
     float getWorldSize() const { return worldSize; }
 
+    static const int CHUNK_CELLS = 16; // Grid cells per chunk side
+
 private:
     float worldSize;    // Half-extent: terrain spans [-worldSize, +worldSize]
     int gridRes;        // Number of grid cells per axis
     std::vector<float> heightmap; // (gridRes+1) * (gridRes+1)
+
+    // A CHUNK_CELLS square of the grid (smaller on the far edges) and its
+    // range in the index buffer
+    struct Chunk {
+        float minX, minY, minZ;
+        float maxX, maxY, maxZ;
+        int firstIndex;
+        int indexCount;
+    };
+
+    // GL mesh of the heightmap: one triangle strip over every chunk, row by
+    // row, chunks in row-major order joined by degenerate triangles so that
+    // any run of consecutive chunks is itself one strip
+    unsigned int vertexBuffer;
+    unsigned int indexBuffer;
+    std::vector<Chunk> chunks;
+    bool meshDirty; // Heightmap changed since the buffers were filled
+    TerrainRenderStats stats;
+
+    PhysicsKernels::Heightfield field() const;
+    void buildMesh();
 };
 
 #endif // TERRAIN_H
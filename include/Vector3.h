@@ -0,0 +1,26 @@
+#ifndef VECTOR3_H
+#define VECTOR3_H
+
+#include <cmath>
+
+// Kept apart from MathUtils.h so code without a GL context (physics,
+// terrain queries) does not pull in GL headers
+struct Vector3 {
+    float x, y, z;
+    
+    Vector3(float _x = 0, float _y = 0, float _z = 0) : x(_x), y(_y), z(_z) {}
+    
+    Vector3 operator+(const Vector3& other) const { return Vector3(x + other.x, y + other.y, z + other.z); }
+    Vector3 operator-(const Vector3& other) const { return Vector3(x - other.x, y - other.y, z - other.z); }
+    Vector3 operator*(float scalar) const { return Vector3(x * scalar, y * scalar, z * scalar); }
+    
+    float length() const { return std::sqrt(x * x + y * y + z * z); }
+    
+    Vector3 normalize() const {
+        float len = length();
+        if (len > 0) return *this * (1.0f / len);
+        return *this;
+    }
+};
+
+#endif // VECTOR3_H
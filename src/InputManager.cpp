@@ -1,6 +1,7 @@
 #include "InputManager.h"
 #include "MainWindow.h"
 #include "MathUtils.h"
+#include <cstdio>
 #include <iostream>
 
 InputManager::InputManager(Scene* s, MainWindow* mw) 
@@ -39,6 +40,23 @@ gboolean InputManager::on_scroll_callback(GtkWidget* widget, GdkEventScroll* eve
 // Logic implementations
 
 gboolean InputManager::on_key_press(GtkWidget* widget, GdkEventKey* event) {
+    // F9 toggles physics recording, replayable with PhysicsBench --replay
+    if (event->keyval == GDK_KEY_F9) {
+        const char* path = "physics_recording.bin";
+        uint64_t stateHash = 0;
+        if (!scene->isPhysicsRecording()) {
+            scene->startPhysicsRecording();
+            std::cout << "Physics recording started" << std::endl;
+        } else if (scene->stopPhysicsRecording(path, stateHash)) {
+            char hex[17];
+            std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)stateHash);
+            std::cout << "Physics recording saved to " << path << ", state_hash " << hex << std::endl;
+        } else {
+            std::cerr << "Failed to save physics recording to " << path << std::endl;
+        }
+        return TRUE;
+    }
+
     switch (event->keyval) {
         case GDK_KEY_w: case GDK_KEY_W: isWDown = true; break;
         case GDK_KEY_s: case GDK_KEY_S: isSDown = true; break;
@@ -64,9 +82,6 @@ gboolean InputManager::on_key_release(GtkWidget* widget, GdkEventKey* event) {
 
 void InputManager::updatePhysicsAcceleration() {
     if (scene->getSelected() == -1) return;
-    PhysicsObject* physObj = scene->getPhysicsObject(scene->getSelected());
-    if (!physObj) return;
-
     float acceleration = 20.0f; // Increased to 20.0 for aggressive acceleration
 
     // Get Camera Yaw
@@ -107,8 +122,7 @@ void InputManager::updatePhysicsAcceleration() {
         az *= acceleration;
     }
     
-    physObj->acceleration.x = ax;
-    physObj->acceleration.z = az;
+    scene->setSelectedAcceleration(ax, az);
 }
 
 gboolean InputManager::on_scroll(GtkWidget* widget, GdkEventScroll* event) {
@@ -117,7 +131,7 @@ gboolean InputManager::on_scroll(GtkWidget* widget, GdkEventScroll* event) {
 
     // If a shape (not the light) is selected, cycle its type
     if (sel >= 0 && sel < lightIdx) {
-        const int NUM_TYPES = 5; // SHAPE_CUBE..SHAPE_TRICONE
+        const int NUM_TYPES = SHAPE_TYPE_COUNT;
         int current = (int)scene->getShapeType(sel);
         int next = current;
 
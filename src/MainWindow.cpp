@@ -61,6 +61,23 @@ MainWindow::MainWindow(GtkApplication* app) : scene(new Scene()), inputManager(n
     gtk_box_pack_start(GTK_BOX(tree_count_box), tree_count_spin, FALSE, FALSE, 0);
     gtk_box_pack_start(GTK_BOX(settings_vbox), tree_count_box, FALSE, FALSE, 10);
 
+    // Broadphase Checkbox (unchecked = brute-force pair tests, for benchmarking)
+    spatial_hash_check = gtk_check_button_new_with_label("Spatial Hash Broadphase");
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(spatial_hash_check), TRUE); // Default on
+    g_signal_connect(spatial_hash_check, "toggled", G_CALLBACK(on_spatial_hash_toggled), this);
+    gtk_box_pack_start(GTK_BOX(settings_vbox), spatial_hash_check, FALSE, FALSE, 0);
+
+    // Physics Rate SpinButton (fixed simulation steps per second)
+    GtkWidget* physics_rate_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
+    GtkWidget* physics_rate_label = gtk_label_new("Physics Rate (Hz): ");
+    GtkAdjustment* physics_rate_adj = gtk_adjustment_new(60, 10, 240, 10, 30, 0);
+    physics_rate_spin = gtk_spin_button_new(physics_rate_adj, 1, 0);
+    g_signal_connect(physics_rate_spin, "value-changed", G_CALLBACK(on_physics_rate_changed), this);
+
+    gtk_box_pack_start(GTK_BOX(physics_rate_box), physics_rate_label, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(physics_rate_box), physics_rate_spin, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(settings_vbox), physics_rate_box, FALSE, FALSE, 10);
+
     back_button = gtk_button_new_with_label("Back");
     gtk_widget_set_size_request(back_button, 200, 50);
     g_signal_connect(back_button, "clicked", G_CALLBACK(on_back_clicked), this);
@@ -143,8 +160,8 @@ MainWindow::MainWindow(GtkApplication* app) : scene(new Scene()), inputManager(n
     // Show the menu by default
     gtk_stack_set_visible_child_name(GTK_STACK(stack), "menu");
 
-    // Game Loop (approx 60 FPS)
-    g_timeout_add(16, (GSourceFunc)on_tick, this);
+    // Game Loop, driven by the display's frame clock
+    gtk_widget_add_tick_callback(gl_area, on_tick, this, NULL);
 }
 
 MainWindow::~MainWindow() {
@@ -190,6 +207,7 @@ Vector3 MainWindow::getSelectedColor() const {
 void MainWindow::on_start_clicked(GtkWidget* widget, gpointer data) {
     MainWindow* mw = static_cast<MainWindow*>(data);
     mw->is_simulation_running = true;
+    mw->scene->setSimulationRunning(true);
     gtk_stack_set_visible_child_name(GTK_STACK(mw->stack), "simulation");
 }
 
@@ -215,6 +233,17 @@ void MainWindow::on_tree_count_changed(GtkSpinButton* widget, gpointer data) {
     mw->scene->setTreeCount(count);
 }
 
+void MainWindow::on_spatial_hash_toggled(GtkToggleButton* widget, gpointer data) {
+    MainWindow* mw = static_cast<MainWindow*>(data);
+    bool enabled = gtk_toggle_button_get_active(widget);
+    mw->scene->setBroadphaseMode(enabled ? BROADPHASE_SPATIAL_HASH : BROADPHASE_BRUTE_FORCE);
+}
+
+void MainWindow::on_physics_rate_changed(GtkSpinButton* widget, gpointer data) {
+    MainWindow* mw = static_cast<MainWindow*>(data);
+    mw->scene->setPhysicsRate((float)gtk_spin_button_get_value(widget));
+}
+
 void MainWindow::on_button_clicked(GtkWidget* widget, gpointer data) {
     MainWindow* mw = static_cast<MainWindow*>(data);
     
@@ -254,13 +283,12 @@ gboolean MainWindow::on_resize(GtkGLArea* area, gint width, gint height, gpointe
     return TRUE;
 }
 
-gboolean MainWindow::on_tick(gpointer data) {
+gboolean MainWindow::on_tick(GtkWidget* widget, GdkFrameClock* clock, gpointer data) {
     MainWindow* mw = static_cast<MainWindow*>(data);
-    if (mw->is_simulation_running) {
-        // DT is fixed 0.016f for now, or calculate real dt
-        mw->scene->update(0.016f);
-        gtk_widget_queue_draw(mw->gl_area);
-    }
-    return TRUE; // Continue calling
+    if (!mw->is_simulation_running) return G_SOURCE_CONTINUE;
+
+    // Physics steps on its own thread; each frame just draws its latest state
+    gtk_widget_queue_draw(mw->gl_area);
+    return G_SOURCE_CONTINUE;
 }
 
@@ -0,0 +1,285 @@
+#include "Physics/BodyBVH.h"
+#include <algorithm>
+
+namespace {
+
+const float REBUILD_GROWTH = 2.0f; // Refit area over built area that asks for a rebuild
+
+float halfArea(const float bmin[3], const float bmax[3]) {
+    float dx = bmax[0] - bmin[0];
+    float dy = bmax[1] - bmin[1];
+    float dz = bmax[2] - bmin[2];
+    return dx * dy + dy * dz + dz * dx;
+}
+
+// Scalar slab test, the same operations as one lane of
+// PhysicsKernels::slabTest with the box grown by 'expand'
+bool slab(const float bmin[3], const float bmax[3], const float o[3], const float inv[3], const float e[3],
+          float maxT, float& t) {
+    float x0 = (bmin[0] - e[0] - o[0]) * inv[0], x1 = (bmax[0] + e[0] - o[0]) * inv[0];
+    float y0 = (bmin[1] - e[1] - o[1]) * inv[1], y1 = (bmax[1] + e[1] - o[1]) * inv[1];
+    float z0 = (bmin[2] - e[2] - o[2]) * inv[2], z1 = (bmax[2] + e[2] - o[2]) * inv[2];
+    float enter = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), 0.0f));
+    float exit = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::max(z0, z1));
+    t = enter;
+    return enter <= exit && enter <= maxT;
+}
+
+// Nearer hit, or the lower id at the same distance
+bool better(float t, int id, float bestT, int bestId) {
+    return t < bestT || (t == bestT && (bestId < 0 || id < bestId));
+}
+
+} // namespace
+
+BodyBVH::BodyBVH() : builtArea(0.0f) {}
+
+void BodyBVH::bodyBounds(const PhysicsBodyStore& b, int id, float bmin[3], float bmax[3]) const {
+    bmin[0] = b.posX[id] - b.sizeX[id];
+    bmin[1] = b.posY[id] - b.sizeY[id];
+    bmin[2] = b.posZ[id] - b.sizeZ[id];
+    bmax[0] = b.posX[id] + b.sizeX[id];
+    bmax[1] = b.posY[id] + b.sizeY[id];
+    bmax[2] = b.posZ[id] + b.sizeZ[id];
+}
+
+void BodyBVH::leafBounds(const PhysicsBodyStore& b, Node& node) const {
+    bodyBounds(b, order[node.first], node.bmin, node.bmax);
+    for (uint32_t k = 1; k < node.count; k++) {
+        float lo[3], hi[3];
+        bodyBounds(b, order[node.first + k], lo, hi);
+        for (int a = 0; a < 3; a++) {
+            node.bmin[a] = std::min(node.bmin[a], lo[a]);
+            node.bmax[a] = std::max(node.bmax[a], hi[a]);
+        }
+    }
+}
+
+float BodyBVH::innerArea() const {
+    float area = 0.0f;
+    for (const Node& node : nodes) {
+        if (node.count == 0) area += halfArea(node.bmin, node.bmax);
+    }
+    return area;
+}
+
+// ================================================================
+// Build and refit
+// ================================================================
+void BodyBVH::build(const PhysicsBodyStore& b) {
+    const size_t count = b.size();
+    nodes.clear();
+    order.resize(count);
+    centers.resize(count * 3);
+    for (size_t i = 0; i < count; i++) {
+        order[i] = (int)i;
+        centers[i * 3 + 0] = b.posX[i];
+        centers[i * 3 + 1] = b.posY[i];
+        centers[i * 3 + 2] = b.posZ[i];
+    }
+    if (count == 0) return;
+
+    nodes.reserve(2 * (count / LEAF_SIZE + 1));
+    buildNode(b, 0, (uint32_t)count);
+    builtArea = innerArea();
+}
+
+uint32_t BodyBVH::buildNode(const PhysicsBodyStore& b, uint32_t begin, uint32_t end) {
+    uint32_t index = (uint32_t)nodes.size();
+    nodes.push_back(Node());
+
+    if (end - begin <= LEAF_SIZE) {
+        nodes[index].first = begin;
+        nodes[index].count = end - begin;
+        leafBounds(b, nodes[index]);
+        return index;
+    }
+
+    // Split at the median centre along the axis the centres spread most
+    float lo[3] = { centers[order[begin] * 3], centers[order[begin] * 3 + 1], centers[order[begin] * 3 + 2] };
+    float hi[3] = { lo[0], lo[1], lo[2] };
+    for (uint32_t i = begin + 1; i < end; i++) {
+        for (int a = 0; a < 3; a++) {
+            lo[a] = std::min(lo[a], centers[order[i] * 3 + a]);
+            hi[a] = std::max(hi[a], centers[order[i] * 3 + a]);
+        }
+    }
+    int axis = 0;
+    if (hi[1] - lo[1] > hi[axis] - lo[axis]) axis = 1;
+    if (hi[2] - lo[2] > hi[axis] - lo[axis]) axis = 2;
+
+    uint32_t mid = begin + (end - begin) / 2;
+    const float* c = centers.data();
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end, [c, axis](int x, int y) {
+        return c[x * 3 + axis] < c[y * 3 + axis] || (c[x * 3 + axis] == c[y * 3 + axis] && x < y);
+    });
+
+    buildNode(b, begin, mid);
+    uint32_t right = buildNode(b, mid, end);
+
+    Node& node = nodes[index];
+    const Node& l = nodes[index + 1];
+    const Node& r = nodes[right];
+    node.first = right;
+    node.count = 0;
+    for (int a = 0; a < 3; a++) {
+        node.bmin[a] = std::min(l.bmin[a], r.bmin[a]);
+        node.bmax[a] = std::max(l.bmax[a], r.bmax[a]);
+    }
+    return index;
+}
+
+bool BodyBVH::refit(const PhysicsBodyStore& b) {
+    // Children always come after their parent
+    for (size_t i = nodes.size(); i-- > 0; ) {
+        Node& node = nodes[i];
+        if (node.count > 0) {
+            leafBounds(b, node);
+            continue;
+        }
+        const Node& l = nodes[i + 1];
+        const Node& r = nodes[node.first];
+        for (int a = 0; a < 3; a++) {
+            node.bmin[a] = std::min(l.bmin[a], r.bmin[a]);
+            node.bmax[a] = std::max(l.bmax[a], r.bmax[a]);
+        }
+    }
+    return innerArea() <= builtArea * REBUILD_GROWTH;
+}
+
+// ================================================================
+// Queries
+// ================================================================
+int BodyBVH::raycast(const PhysicsBodyStore& b, const float origin[3], const float invDir[3],
+                     const float expand[3], float maxT, uint32_t layerMask, float& outT) const {
+    if (nodes.empty()) return -1;
+
+    struct Entry {
+        uint32_t node;
+        float t;
+    };
+    Entry stack[STACK_SIZE];
+    int top = 0;
+
+    float t;
+    if (!slab(nodes[0].bmin, nodes[0].bmax, origin, invDir, expand, maxT, t)) return -1;
+    stack[top++] = { 0, t };
+
+    int best = -1;
+    float bestT = maxT;
+    while (top > 0) {
+        Entry e = stack[--top];
+        if (e.t > bestT) continue; // A closer hit was found since it was pushed
+        const Node& node = nodes[e.node];
+
+        if (node.count > 0) {
+            for (uint32_t k = 0; k < node.count; k++) {
+                int id = order[node.first + k];
+                if (!(b.category[id] & layerMask)) continue;
+                float lo[3], hi[3];
+                bodyBounds(b, id, lo, hi);
+                if (slab(lo, hi, origin, invDir, expand, bestT, t) && better(t, id, bestT, best)) {
+                    bestT = t;
+                    best = id;
+                }
+            }
+            continue;
+        }
+
+        // Visit the nearer child first
+        uint32_t children[2] = { e.node + 1, node.first };
+        float tc[2];
+        bool hit[2];
+        for (int c = 0; c < 2; c++) {
+            hit[c] = slab(nodes[children[c]].bmin, nodes[children[c]].bmax, origin, invDir, expand, bestT, tc[c]);
+        }
+        int nearer = (hit[1] && (!hit[0] || tc[1] < tc[0])) ? 1 : 0;
+        int farther = 1 - nearer;
+        if (hit[farther]) stack[top++] = { children[farther], tc[farther] };
+        if (hit[nearer]) stack[top++] = { children[nearer], tc[nearer] };
+    }
+
+    outT = bestT;
+    return best;
+}
+
+void BodyBVH::raycastPacket(const PhysicsBodyStore& b, const PhysicsKernels::RayPacket& rays,
+                            uint32_t activeLanes, uint32_t layerMask, float* tBest, int* hitId) const {
+    if (nodes.empty() || activeLanes == 0) return;
+
+    // Front-to-back order follows the first active ray
+    int lead = 0;
+    while (!(activeLanes & (1u << lead))) lead++;
+    const float leadDir[3] = { rays.invDirX[lead], rays.invDirY[lead], rays.invDirZ[lead] };
+
+    uint32_t stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+    float tEntry[PhysicsKernels::RAY_PACKET_SIZE];
+
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        // Lanes whose ray reaches the node before their best hit so far
+        if (!(PhysicsKernels::slabTest(rays, node.bmin, node.bmax, tBest, tEntry) & activeLanes)) continue;
+
+        if (node.count > 0) {
+            for (uint32_t k = 0; k < node.count; k++) {
+                int id = order[node.first + k];
+                if (!(b.category[id] & layerMask)) continue;
+                float lo[3], hi[3];
+                bodyBounds(b, id, lo, hi);
+                uint32_t lanes = PhysicsKernels::slabTest(rays, lo, hi, tBest, tEntry) & activeLanes;
+                for (; lanes; lanes &= lanes - 1) {
+                    int lane = __builtin_ctz(lanes);
+                    if (better(tEntry[lane], id, tBest[lane], hitId[lane])) {
+                        tBest[lane] = tEntry[lane];
+                        hitId[lane] = id;
+                    }
+                }
+            }
+            continue;
+        }
+
+        // Children split along the node's widest axis; push the one the
+        // lead ray reaches second first
+        uint32_t left = (uint32_t)(&node - nodes.data()) + 1;
+        int axis = 0;
+        for (int a = 1; a < 3; a++) {
+            if (node.bmax[a] - node.bmin[a] > node.bmax[axis] - node.bmin[axis]) axis = a;
+        }
+        bool leftFirst = leadDir[axis] >= 0.0f;
+        stack[top++] = leftFirst ? node.first : left;
+        stack[top++] = leftFirst ? left : node.first;
+    }
+}
+
+void BodyBVH::overlap(const PhysicsBodyStore& b, const float bmin[3], const float bmax[3], uint32_t layerMask,
+                      std::vector<int>& out) const {
+    if (nodes.empty()) return;
+
+    uint32_t stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (node.bmin[0] > bmax[0] || node.bmax[0] < bmin[0] || node.bmin[1] > bmax[1] ||
+            node.bmax[1] < bmin[1] || node.bmin[2] > bmax[2] || node.bmax[2] < bmin[2]) {
+            continue;
+        }
+        if (node.count == 0) {
+            stack[top++] = node.first;
+            stack[top++] = (uint32_t)(&node - nodes.data()) + 1;
+            continue;
+        }
+        for (uint32_t k = 0; k < node.count; k++) {
+            int id = order[node.first + k];
+            if (!(b.category[id] & layerMask)) continue;
+            float lo[3], hi[3];
+            bodyBounds(b, id, lo, hi);
+            if (lo[0] <= bmax[0] && hi[0] >= bmin[0] && lo[1] <= bmax[1] && hi[1] >= bmin[1] &&
+                lo[2] <= bmax[2] && hi[2] >= bmin[2]) {
+                out.push_back(id);
+            }
+        }
+    }
+}
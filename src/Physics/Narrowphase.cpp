@@ -0,0 +1,224 @@
+#include "Physics/Narrowphase.h"
+#include "Vector3.h"
+#include <algorithm>
+#include <cmath>
+
+using Narrowphase::Collider;
+
+namespace {
+
+const int GJK_MAX_ITERATIONS = 32;
+const float GJK_EPSILON = 1e-12f; // Squared length below which the search direction is degenerate
+
+float dot(const Vector3& a, const Vector3& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+Vector3 cross(const Vector3& a, const Vector3& b) {
+    return Vector3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+float sphereRadius(const Collider& c) {
+    return std::min(std::min(c.half[0], c.half[1]), c.half[2]);
+}
+
+float roundRadius(const Collider& c) {
+    return std::min(c.half[0], c.half[2]);
+}
+
+// Gap between a point and a centered interval, 0 inside
+float outside(float d, float half) {
+    return std::max(std::abs(d) - half, 0.0f);
+}
+
+// ================================================================
+// Closed-form tests
+// ================================================================
+bool sphereSphere(const Collider& a, const Collider& b) {
+    float dx = a.center[0] - b.center[0];
+    float dy = a.center[1] - b.center[1];
+    float dz = a.center[2] - b.center[2];
+    float r = sphereRadius(a) + sphereRadius(b);
+    return dx * dx + dy * dy + dz * dz < r * r;
+}
+
+bool sphereBox(const Collider& s, const Collider& box) {
+    float gap2 = 0.0f;
+    for (int k = 0; k < 3; k++) {
+        float g = outside(s.center[k] - box.center[k], box.half[k]);
+        gap2 += g * g;
+    }
+    float r = sphereRadius(s);
+    return gap2 < r * r;
+}
+
+// A Y-axis cylinder is a disc times an interval, so the closest point to
+// the sphere centre splits into a radial and a vertical part
+bool sphereCylinder(const Collider& s, const Collider& cyl) {
+    float dx = s.center[0] - cyl.center[0];
+    float dz = s.center[2] - cyl.center[2];
+    float radial = std::max(std::sqrt(dx * dx + dz * dz) - roundRadius(cyl), 0.0f);
+    float vertical = outside(s.center[1] - cyl.center[1], cyl.half[1]);
+    float r = sphereRadius(s);
+    return radial * radial + vertical * vertical < r * r;
+}
+
+// Both shapes are an XZ footprint times a Y interval: overlap on Y and
+// disc against rectangle on XZ
+bool cylinderBox(const Collider& cyl, const Collider& box) {
+    if (std::abs(cyl.center[1] - box.center[1]) >= cyl.half[1] + box.half[1]) return false;
+    float gx = outside(cyl.center[0] - box.center[0], box.half[0]);
+    float gz = outside(cyl.center[2] - box.center[2], box.half[2]);
+    float r = roundRadius(cyl);
+    return gx * gx + gz * gz < r * r;
+}
+
+bool cylinderCylinder(const Collider& a, const Collider& b) {
+    if (std::abs(a.center[1] - b.center[1]) >= a.half[1] + b.half[1]) return false;
+    float dx = a.center[0] - b.center[0];
+    float dz = a.center[2] - b.center[2];
+    float r = roundRadius(a) + roundRadius(b);
+    return dx * dx + dz * dz < r * r;
+}
+
+// ================================================================
+// GJK
+// ================================================================
+
+// Farthest point of the shape along 'd'
+Vector3 support(const Collider& c, const Vector3& d) {
+    Vector3 center(c.center[0], c.center[1], c.center[2]);
+    switch (c.shape) {
+        case COLLISION_SPHERE: {
+            float len = d.length();
+            float r = sphereRadius(c);
+            return len > 0.0f ? center + d * (r / len) : center + Vector3(r, 0, 0);
+        }
+        case COLLISION_CYLINDER:
+        case COLLISION_CONE: {
+            float h = c.half[1];
+            float len = std::sqrt(d.x * d.x + d.z * d.z);
+            float r = roundRadius(c);
+            Vector3 rim = len > 0.0f ? Vector3(d.x * r / len, 0, d.z * r / len) : Vector3();
+            if (c.shape == COLLISION_CYLINDER) return center + rim + Vector3(0, d.y >= 0.0f ? h : -h, 0);
+
+            Vector3 apex = center + Vector3(0, h, 0);
+            Vector3 base = center + rim + Vector3(0, -h, 0);
+            return dot(apex, d) >= dot(base, d) ? apex : base;
+        }
+        default:
+            return center + Vector3(d.x >= 0.0f ? c.half[0] : -c.half[0],
+                                    d.y >= 0.0f ? c.half[1] : -c.half[1],
+                                    d.z >= 0.0f ? c.half[2] : -c.half[2]);
+    }
+}
+
+// Support of the Minkowski difference a - b
+Vector3 support(const Collider& a, const Collider& b, const Vector3& d) {
+    return support(a, d) - support(b, d * -1.0f);
+}
+
+// The simplex keeps its newest point last. Each case drops the features
+// that cannot be closest to the origin and sets the next search direction.
+void lineCase(Vector3* pts, int& n, Vector3& d) {
+    Vector3 a = pts[1], b = pts[0];
+    Vector3 ab = b - a, ao = a * -1.0f;
+    if (dot(ab, ao) > 0.0f) {
+        d = cross(cross(ab, ao), ab);
+    } else {
+        pts[0] = a;
+        n = 1;
+        d = ao;
+    }
+}
+
+void triangleCase(Vector3* pts, int& n, Vector3& d) {
+    Vector3 a = pts[2], b = pts[1], c = pts[0];
+    Vector3 ab = b - a, ac = c - a, ao = a * -1.0f;
+    Vector3 abc = cross(ab, ac);
+
+    if (dot(cross(abc, ac), ao) > 0.0f) {
+        if (dot(ac, ao) > 0.0f) {
+            pts[0] = c; pts[1] = a; n = 2;
+            d = cross(cross(ac, ao), ac);
+        } else {
+            pts[0] = b; pts[1] = a; n = 2;
+            lineCase(pts, n, d);
+        }
+    } else if (dot(cross(ab, abc), ao) > 0.0f) {
+        pts[0] = b; pts[1] = a; n = 2;
+        lineCase(pts, n, d);
+    } else if (dot(abc, ao) > 0.0f) {
+        d = abc;
+    } else {
+        pts[0] = b; pts[1] = c;
+        d = abc * -1.0f;
+    }
+}
+
+// True once the tetrahedron encloses the origin
+bool tetrahedronCase(Vector3* pts, int& n, Vector3& d) {
+    Vector3 a = pts[3];
+    Vector3 ao = a * -1.0f;
+
+    // Faces through the newest point, each with the vertex left out; the
+    // origin cannot lie beyond the old base, which was searched already
+    const int faces[3][3] = { { 2, 1, 0 }, { 1, 0, 2 }, { 0, 2, 1 } };
+    for (const auto& f : faces) {
+        Vector3 b = pts[f[0]], c = pts[f[1]], other = pts[f[2]];
+        Vector3 normal = cross(b - a, c - a);
+        if (dot(normal, other - a) > 0.0f) normal = normal * -1.0f; // Point outwards
+        if (dot(normal, ao) > 0.0f) {
+            pts[0] = c; pts[1] = b; pts[2] = a; n = 3;
+            triangleCase(pts, n, d);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool gjk(const Collider& a, const Collider& b) {
+    Vector3 d(a.center[0] - b.center[0], a.center[1] - b.center[1], a.center[2] - b.center[2]);
+    if (dot(d, d) < GJK_EPSILON) return true; // Same centre
+
+    Vector3 pts[4];
+    pts[0] = support(a, b, d);
+    int n = 1;
+    d = pts[0] * -1.0f;
+
+    for (int iter = 0; iter < GJK_MAX_ITERATIONS; iter++) {
+        if (dot(d, d) < GJK_EPSILON) return true; // Origin on the simplex
+
+        Vector3 p = support(a, b, d);
+        if (dot(p, d) <= 0.0f) return false; // Separating direction found
+        pts[n++] = p;
+
+        if (n == 2) lineCase(pts, n, d);
+        else if (n == 3) triangleCase(pts, n, d);
+        else if (tetrahedronCase(pts, n, d)) return true;
+    }
+    return true; // Undecided after the cap: keep the AABB verdict
+}
+
+} // namespace
+
+bool Narrowphase::intersect(const Collider& a, const Collider& b) {
+    // Order the pair so each closed-form case is handled once
+    const Collider* first = &a;
+    const Collider* second = &b;
+    if (first->shape > second->shape) std::swap(first, second);
+
+    if (second->shape == COLLISION_CONE) return gjk(*first, *second);
+
+    switch (first->shape) {
+        case COLLISION_BOX:
+            if (second->shape == COLLISION_BOX) return true; // The AABB test was exact
+            if (second->shape == COLLISION_SPHERE) return sphereBox(*second, *first);
+            return cylinderBox(*second, *first);
+        case COLLISION_SPHERE:
+            if (second->shape == COLLISION_SPHERE) return sphereSphere(*first, *second);
+            return sphereCylinder(*first, *second);
+        default:
+            return cylinderCylinder(*first, *second);
+    }
+}
@@ -1,210 +1,1197 @@
 #include "Physics/PhysicsEngine.h"
+#include "Physics/PhysicsKernels.h"
+#include "Physics/PhysicsRecorder.h"
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <iostream>
 
-PhysicsEngine::PhysicsEngine() {
+PhysicsEngine::PhysicsEngine(int workerCount)
+    : broadphaseMode(BROADPHASE_SPATIAL_HASH), sleepEnabled(true), sleepVelocity(0.05f), sleepTime(0.5f),
+      ccdEnabled(true), ccdThreshold(1.0f), contactsEnabled(true),
+      solverIterations(8), solverTolerance(0.001f), lodEnabled(false), lodNear(30.0f), lodFar(60.0f),
+      lodHysteresis(2.0f), lodStep(0), spatialSortEnabled(false), spatialSortInterval(30),
+      spatialSortThreshold(0.1f), spatialSortStep(0), queryTreeState(QUERY_TREE_STALE), raycastMode(RAYCAST_PACKET),
+      recorder(nullptr) {
+    // One worker per core by default (capped); results do not depend on it
+    if (workerCount <= 0) {
+        unsigned cores = std::thread::hardware_concurrency();
+        workerCount = cores == 0 ? 1 : (int)std::min(cores, 8u);
+    }
+    workerPool.setThreadCount(workerCount);
 }
 
 PhysicsEngine::~PhysicsEngine() {
-    for (auto obj : objects) {
-        delete obj;
+}
+
+PhysicsHandle PhysicsEngine::addObject(const Vector3& initialPos) {
+    PhysicsObject desc;
+    desc.position = initialPos;
+    return addObject(desc);
+}
+
+PhysicsHandle PhysicsEngine::addObject(const PhysicsObject& desc) {
+    if (recorder) recorder->recordAdd(desc);
+
+    size_t index = bodies.size();
+    bodies.resize(index + 1);
+
+    // Reuse a free slot if there is one; its generation was bumped on release
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = (uint32_t)slots.size();
+        Slot fresh;
+        fresh.generation = 1;
+        slots.push_back(fresh);
+    }
+    slots[slot].dense = (uint32_t)index;
+    bodies.slots[index] = slot;
+
+    bodies.posX[index] = desc.position.x;
+    bodies.posY[index] = desc.position.y;
+    bodies.posZ[index] = desc.position.z;
+    bodies.velX[index] = desc.velocity.x;
+    bodies.velY[index] = desc.velocity.y;
+    bodies.velZ[index] = desc.velocity.z;
+    bodies.accX[index] = desc.acceleration.x;
+    bodies.accY[index] = desc.acceleration.y;
+    bodies.accZ[index] = desc.acceleration.z;
+    bodies.sizeX[index] = desc.size.x;
+    bodies.sizeY[index] = desc.size.y;
+    bodies.sizeZ[index] = desc.size.z;
+    bodies.mass[index] = desc.mass;
+    bodies.friction[index] = desc.friction;
+    bodies.restitution[index] = desc.restitution;
+    bodies.shape[index] = (uint32_t)desc.shape;
+    bodies.category[index] = desc.collisionCategory;
+    bodies.mask[index] = desc.collisionMask;
+    bodies.isStatic[index] = desc.isStatic ? ~0u : 0u;
+    bodies.isAsleep[index] = 0u;
+    bodies.sleepTimer[index] = 0.0f;
+    bodies.groundImpulse[index] = 0.0f;
+    bodies.lodBand[index] = LOD_FULL;
+    bodies.lodElapsed[index] = 0.0f;
+    markQueryTree(QUERY_TREE_STALE);
+    return PhysicsHandle(slot, slots[slot].generation);
+}
+
+void PhysicsEngine::releaseSlot(uint32_t slot) {
+    slots[slot].dense = PhysicsHandle::INVALID_INDEX;
+    slots[slot].generation++;
+    freeSlots.push_back(slot);
+}
+
+void PhysicsEngine::removeObject(PhysicsHandle handle) {
+    int index = indexOf(handle);
+    if (index < 0) return;
+    if (recorder) recorder->recordRemove(&handle, 1);
+
+    // Swap-and-pop: the last body takes over the removed body's dense index
+    size_t last = bodies.size() - 1;
+    bodies.swapRemove(index);
+    if ((size_t)index != last) {
+        slots[bodies.slots[index]].dense = (uint32_t)index;
     }
-    objects.clear();
+    releaseSlot(handle.index);
+    markQueryTree(QUERY_TREE_STALE);
+
+    // Anything may have been resting on the removed body
+    wakeAll();
 }
 
-PhysicsObject* PhysicsEngine::addObject(const Vector3& initialPos) {
-    PhysicsObject* obj = new PhysicsObject();
-    obj->position = initialPos;
-    objects.push_back(obj);
+void PhysicsEngine::removeObjects(const std::vector<PhysicsHandle>& handles) {
+    if (recorder && !handles.empty()) recorder->recordRemove(handles.data(), handles.size());
+    removedScratch.assign(bodies.size(), 0);
+    size_t removedCount = 0;
+    for (const PhysicsHandle& handle : handles) {
+        int index = indexOf(handle);
+        if (index < 0) continue;
+        removedScratch[index] = 1;
+        releaseSlot(handle.index);
+        removedCount++;
+    }
+    if (removedCount == 0) return;
+
+    bodies.compact(removedScratch);
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        slots[bodies.slots[i]].dense = (uint32_t)i;
+    }
+    markQueryTree(QUERY_TREE_STALE);
+    wakeAll();
+}
+
+void PhysicsEngine::clear() {
+    if (recorder) recorder->recordClear();
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        releaseSlot(bodies.slots[i]);
+    }
+    bodies.clear();
+    markQueryTree(QUERY_TREE_STALE);
+}
+
+int PhysicsEngine::indexOf(PhysicsHandle handle) const {
+    if (handle.index >= slots.size()) return -1;
+    const Slot& slot = slots[handle.index];
+    if (slot.generation != handle.generation || slot.dense == PhysicsHandle::INVALID_INDEX) return -1;
+    return (int)slot.dense;
+}
+
+bool PhysicsEngine::isValid(PhysicsHandle handle) const {
+    return indexOf(handle) >= 0;
+}
+
+PhysicsObject PhysicsEngine::getObject(PhysicsHandle handle) const {
+    PhysicsObject obj;
+    int i = indexOf(handle);
+    if (i < 0) return obj;
+
+    obj.position = Vector3(bodies.posX[i], bodies.posY[i], bodies.posZ[i]);
+    obj.velocity = Vector3(bodies.velX[i], bodies.velY[i], bodies.velZ[i]);
+    obj.acceleration = Vector3(bodies.accX[i], bodies.accY[i], bodies.accZ[i]);
+    obj.mass = bodies.mass[i];
+    obj.friction = bodies.friction[i];
+    obj.restitution = bodies.restitution[i];
+    obj.isStatic = bodies.isStatic[i] != 0;
+    obj.size = Vector3(bodies.sizeX[i], bodies.sizeY[i], bodies.sizeZ[i]);
+    obj.shape = (CollisionShape)bodies.shape[i];
+    obj.collisionCategory = bodies.category[i];
+    obj.collisionMask = bodies.mask[i];
     return obj;
 }
 
-void PhysicsEngine::removeObject(PhysicsObject* obj) {
-    auto it = std::find(objects.begin(), objects.end(), obj);
-    if (it != objects.end()) {
-        delete *it;
-        objects.erase(it);
+Vector3 PhysicsEngine::getPosition(PhysicsHandle handle) const {
+    int i = indexOf(handle);
+    if (i < 0) return Vector3();
+    return Vector3(bodies.posX[i], bodies.posY[i], bodies.posZ[i]);
+}
+
+Vector3 PhysicsEngine::getVelocity(PhysicsHandle handle) const {
+    int i = indexOf(handle);
+    if (i < 0) return Vector3();
+    return Vector3(bodies.velX[i], bodies.velY[i], bodies.velZ[i]);
+}
+
+Vector3 PhysicsEngine::getAcceleration(PhysicsHandle handle) const {
+    int i = indexOf(handle);
+    if (i < 0) return Vector3();
+    return Vector3(bodies.accX[i], bodies.accY[i], bodies.accZ[i]);
+}
+
+void PhysicsEngine::copySlotPositions(std::vector<Vector3>& positions, std::vector<uint32_t>& generations) const {
+    positions.resize(slots.size());
+    generations.assign(slots.size(), 0u);
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        uint32_t slot = bodies.slots[i];
+        positions[slot] = Vector3(bodies.posX[i], bodies.posY[i], bodies.posZ[i]);
+        generations[slot] = slots[slot].generation;
     }
 }
 
+void PhysicsEngine::setPosition(PhysicsHandle handle, const Vector3& position) {
+    int i = indexOf(handle);
+    if (i < 0) return;
+    if (recorder) recorder->recordVector(PhysicsRecorder::EVENT_SET_POSITION, handle, position);
+    bodies.posX[i] = position.x;
+    bodies.posY[i] = position.y;
+    bodies.posZ[i] = position.z;
+    markQueryTree(QUERY_TREE_MOVED);
+    wake(i); // Teleported, its old resting contacts no longer hold
+}
+
+void PhysicsEngine::setVelocity(PhysicsHandle handle, const Vector3& velocity) {
+    int i = indexOf(handle);
+    if (i < 0) return;
+    if (recorder) recorder->recordVector(PhysicsRecorder::EVENT_SET_VELOCITY, handle, velocity);
+    bodies.velX[i] = velocity.x;
+    bodies.velY[i] = velocity.y;
+    bodies.velZ[i] = velocity.z;
+    wake(i);
+}
+
+void PhysicsEngine::setAcceleration(PhysicsHandle handle, const Vector3& acceleration) {
+    int i = indexOf(handle);
+    if (i < 0) return;
+    if (bodies.accX[i] == acceleration.x && bodies.accY[i] == acceleration.y &&
+        bodies.accZ[i] == acceleration.z) {
+        return;
+    }
+
+    // Input writes arrive every frame; only real changes are recorded
+    if (recorder) recorder->recordVector(PhysicsRecorder::EVENT_SET_ACCELERATION, handle, acceleration);
+    wake(i);
+    bodies.accX[i] = acceleration.x;
+    bodies.accY[i] = acceleration.y;
+    bodies.accZ[i] = acceleration.z;
+}
+
+void PhysicsEngine::setMass(PhysicsHandle handle, float mass) {
+    int i = indexOf(handle);
+    if (i < 0) return;
+    if (recorder) recorder->recordScalar(PhysicsRecorder::EVENT_SET_MASS, handle, mass);
+    bodies.mass[i] = mass;
+}
+
+void PhysicsEngine::setFriction(PhysicsHandle handle, float friction) {
+    int i = indexOf(handle);
+    if (i < 0) return;
+    if (recorder) recorder->recordScalar(PhysicsRecorder::EVENT_SET_FRICTION, handle, friction);
+    bodies.friction[i] = friction;
+}
+
+void PhysicsEngine::setRestitution(PhysicsHandle handle, float restitution) {
+    int i = indexOf(handle);
+    if (i < 0) return;
+    if (recorder) recorder->recordScalar(PhysicsRecorder::EVENT_SET_RESTITUTION, handle, restitution);
+    bodies.restitution[i] = restitution;
+}
+
+void PhysicsEngine::setStatic(PhysicsHandle handle, bool isStatic) {
+    int i = indexOf(handle);
+    if (i < 0) return;
+    if (recorder) recorder->recordScalar(PhysicsRecorder::EVENT_SET_STATIC, handle, isStatic ? 1.0f : 0.0f);
+    bodies.isStatic[i] = isStatic ? ~0u : 0u;
+    wake(i);
+}
+
+void PhysicsEngine::setSize(PhysicsHandle handle, const Vector3& size) {
+    int i = indexOf(handle);
+    if (i < 0) return;
+    if (recorder) recorder->recordVector(PhysicsRecorder::EVENT_SET_SIZE, handle, size);
+    bodies.sizeX[i] = size.x;
+    bodies.sizeY[i] = size.y;
+    bodies.sizeZ[i] = size.z;
+    markQueryTree(QUERY_TREE_MOVED);
+    wake(i);
+}
+
+void PhysicsEngine::setShape(PhysicsHandle handle, CollisionShape shape) {
+    int i = indexOf(handle);
+    if (i < 0) return;
+    if (recorder) recorder->recordScalar(PhysicsRecorder::EVENT_SET_SHAPE, handle, (float)shape);
+    bodies.shape[i] = (uint32_t)shape;
+    wake(i);
+}
+
+void PhysicsEngine::setCollisionFilter(PhysicsHandle handle, uint32_t category, uint32_t mask) {
+    int i = indexOf(handle);
+    if (i < 0) return;
+    if (recorder) recorder->recordFilter(handle, category, mask);
+    bodies.category[i] = category;
+    bodies.mask[i] = mask;
+    wake(i);
+}
+
+void PhysicsEngine::setSleepEnabled(bool enabled) {
+    if (recorder) recorder->recordSetting(PhysicsRecorder::EVENT_SLEEP_ENABLED, enabled ? 1.0f : 0.0f);
+    sleepEnabled = enabled;
+    if (!enabled) wakeAll();
+}
+
+void PhysicsEngine::setSleepThreshold(float velocity, float time) {
+    if (recorder) recorder->recordSetting(PhysicsRecorder::EVENT_SLEEP_THRESHOLD, velocity, time);
+    sleepVelocity = velocity;
+    sleepTime = time;
+}
+
+bool PhysicsEngine::isAsleep(PhysicsHandle handle) const {
+    int i = indexOf(handle);
+    return i >= 0 && bodies.isAsleep[i] != 0;
+}
+
+void PhysicsEngine::wakeObject(PhysicsHandle handle) {
+    int i = indexOf(handle);
+    if (i < 0) return;
+    if (recorder) recorder->recordScalar(PhysicsRecorder::EVENT_WAKE, handle, 0.0f);
+    wake(i);
+}
+
+void PhysicsEngine::setCcdEnabled(bool enabled) {
+    if (recorder) recorder->recordSetting(PhysicsRecorder::EVENT_CCD_ENABLED, enabled ? 1.0f : 0.0f);
+    ccdEnabled = enabled;
+}
+
+void PhysicsEngine::setCcdThreshold(float fraction) {
+    if (recorder) recorder->recordSetting(PhysicsRecorder::EVENT_CCD_THRESHOLD, fraction);
+    ccdThreshold = fraction;
+}
+
+void PhysicsEngine::setSolverIterations(int iterations) {
+    if (recorder) recorder->recordSetting(PhysicsRecorder::EVENT_SOLVER_ITERATIONS, (float)iterations);
+    solverIterations = std::max(1, iterations);
+}
+
+void PhysicsEngine::setSolverTolerance(float tolerance) {
+    if (recorder) recorder->recordSetting(PhysicsRecorder::EVENT_SOLVER_TOLERANCE, tolerance);
+    solverTolerance = tolerance;
+}
+
+void PhysicsEngine::setLodEnabled(bool enabled) {
+    if (recorder) recorder->recordSetting(PhysicsRecorder::EVENT_LOD_ENABLED, enabled ? 1.0f : 0.0f);
+    lodEnabled = enabled;
+}
+
+void PhysicsEngine::setLodFocus(const std::vector<Vector3>& points) {
+    if (recorder) recorder->recordFocus(points.data(), points.size());
+    lodFocus = points;
+}
+
+void PhysicsEngine::setLodDistances(float nearDistance, float farDistance) {
+    if (recorder) recorder->recordSetting(PhysicsRecorder::EVENT_LOD_DISTANCES, nearDistance, farDistance);
+    lodNear = std::max(nearDistance, 0.0f);
+    lodFar = std::max(farDistance, lodNear);
+}
+
+void PhysicsEngine::setLodHysteresis(float margin) {
+    if (recorder) recorder->recordSetting(PhysicsRecorder::EVENT_LOD_HYSTERESIS, margin);
+    lodHysteresis = std::max(margin, 0.0f);
+}
+
+void PhysicsEngine::wake(int i) {
+    bodies.isAsleep[i] = 0u;
+    bodies.sleepTimer[i] = 0.0f;
+}
+
+void PhysicsEngine::wakeAll() {
+    for (size_t i = 0; i < bodies.size(); ++i) wake((int)i);
+}
+
+void PhysicsEngine::setWorkerCount(int count) {
+    workerPool.setThreadCount(count);
+}
+
+int PhysicsEngine::getWorkerCount() const {
+    return workerPool.getThreadCount();
+}
+
+// The step runs in phases, each spread over the worker pool. Every phase
+// either touches disjoint bodies or writes per-chunk / per-island output
+// that is merged in a fixed order, so the result does not depend on how
+// many threads ran it.
 void PhysicsEngine::update(float dt) {
-    const float GRAVITY = -15.0f; // Gravity acceleration (units/s^2)
-
-    for (auto obj : objects) {
-        if (obj->isStatic) continue;
-
-        // Apply gravity
-        obj->velocity.y += GRAVITY * dt;
-
-        // Apply user acceleration (WASD input)
-        // Apply user acceleration (WASD input)
-        obj->velocity.x += obj->acceleration.x * dt;
-        obj->velocity.z += obj->acceleration.z * dt;
-        
-        // Decouple friction: only apply when NOT accelerating, or apply different drag
-        bool isAccelerating = (obj->acceleration.x != 0.0f || obj->acceleration.z != 0.0f);
-        const float MAX_SPEED = 50.0f; // Significantly increased for very fast movement
-        
-        if (isAccelerating) {
-            // Cap horizontal speed
-            float horizSpeed = sqrt(obj->velocity.x * obj->velocity.x + obj->velocity.z * obj->velocity.z);
-            if (horizSpeed > MAX_SPEED) {
-                float scale = MAX_SPEED / horizSpeed;
-                obj->velocity.x *= scale;
-                obj->velocity.z *= scale;
-            }
-        } else {
-            // Apply friction only when not accelerating (stopping)
-            if (obj->friction > 0.0f) {
-                float damping = 1.0f - (obj->friction * dt);
-                if (damping < 0.0f) damping = 0.0f;
-                
-                obj->velocity.x *= damping;
-                obj->velocity.z *= damping;
-                
-                // Stop horizontal movement if very slow
-                float horizSpeed = sqrt(obj->velocity.x * obj->velocity.x + obj->velocity.z * obj->velocity.z);
-                if (horizSpeed < 0.01f) {
-                     obj->velocity.x = 0.0f;
-                     obj->velocity.z = 0.0f;
-                }
+    if (recorder) recorder->recordStep(dt);
+
+    // Storage order is settled before anything indexes the bodies
+    maintainSpatialSort();
+
+    size_t chunks = (bodies.size() + INTEGRATE_CHUNK - 1) / INTEGRATE_CHUNK;
+    if (chunkFastMovers.size() < chunks) chunkFastMovers.resize(chunks);
+    groundHeights.resize(bodies.size());
+    bodyDt.resize(bodies.size());
+    lodParked.resize(bodies.size());
+    chunkLod.assign(chunks * (LOD_BAND_COUNT + 1), 0);
+
+    // Phase 1: integration and terrain contact, independent per body
+    workerPool.parallelFor(bodies.size(), INTEGRATE_CHUNK, [this, dt](size_t begin, size_t end) {
+        assignLodBands(begin, end, dt);
+        // Gravity, input acceleration, damping and position integration run
+        // as a SIMD kernel over the contiguous body columns
+        PhysicsKernels::integrate(bodies, begin, end, bodyDt.data());
+        collectFastMovers(begin, end);
+        resolveGround(begin, end);
+    });
+    lodStep++;
+
+    fastMovers.clear();
+    for (size_t c = 0; c < chunks; ++c) {
+        fastMovers.insert(fastMovers.end(), chunkFastMovers[c].begin(), chunkFastMovers[c].end());
+    }
+    for (int band = 0; band <= LOD_BAND_COUNT; ++band) {
+        int total = 0;
+        for (size_t c = 0; c < chunks; ++c) total += chunkLod[c * (LOD_BAND_COUNT + 1) + band];
+        if (band < LOD_BAND_COUNT) stats.lodBodies[band] = total;
+        else stats.lodParked = total;
+    }
+
+    // Phase 2: stop fast bodies at their first impact, then find
+    // overlapping pairs in ascending (i, j) order
+    buildBroadphase();
+    sweepFastMovers();
+    findPairs();
+    wakeTouchedSleepers();
+    measureContacts();
+
+    // Phase 3: group contacts into islands and solve islands in parallel
+    buildIslands();
+    solveIslands();
+
+    // Phase 4: put bodies that have come to rest to sleep
+    updateSleep();
+
+    // Phase 5: contact events against the previous step
+    classifyContacts();
+
+    // The query tree is refit on demand, so steps without queries skip it
+    markQueryTree(QUERY_TREE_MOVED);
+}
+
+// Picks each dynamic body's band from its distance to the nearest focus
+// point and decides whether it steps this update. A body due to step
+// integrates everything it has accumulated since its last step.
+void PhysicsEngine::assignLodBands(size_t begin, size_t end, float dt) {
+    int* counts = &chunkLod[(begin / INTEGRATE_CHUNK) * (LOD_BAND_COUNT + 1)];
+    const bool active = lodEnabled && !lodFocus.empty();
+
+    // Squared band edges: a body moves out past edge + margin and back in
+    // below edge - margin
+    const float edges[2] = { lodNear, lodFar };
+    float outer2[2], inner2[2];
+    for (int k = 0; k < 2; k++) {
+        float outer = edges[k] + lodHysteresis;
+        float inner = std::max(edges[k] - lodHysteresis, 0.0f);
+        outer2[k] = outer * outer;
+        inner2[k] = inner * inner;
+    }
+
+    for (size_t i = begin; i < end; ++i) {
+        if (bodies.isStatic[i]) {
+            bodyDt[i] = dt;
+            lodParked[i] = 0u;
+            continue;
+        }
+
+        uint32_t band = LOD_FULL;
+        if (active) {
+            float dist2 = std::numeric_limits<float>::max();
+            for (const Vector3& f : lodFocus) {
+                float dx = bodies.posX[i] - f.x;
+                float dy = bodies.posY[i] - f.y;
+                float dz = bodies.posZ[i] - f.z;
+                dist2 = std::min(dist2, dx * dx + dy * dy + dz * dz);
             }
+            // At least as far out as the edges it is clearly past, at most
+            // as far as the edges it is not clearly inside
+            uint32_t lowest = (dist2 > outer2[0]) + (dist2 > outer2[1]);
+            uint32_t highest = (dist2 >= inner2[0]) + (dist2 >= inner2[1]);
+            band = std::min(std::max(bodies.lodBand[i], lowest), highest);
+        }
+        bodies.lodBand[i] = band;
+        counts[band]++;
+
+        if (bodies.isAsleep[i]) {
+            bodies.lodElapsed[i] = 0.0f;
+            bodyDt[i] = dt;
+            lodParked[i] = 0u;
+            continue;
         }
 
-        // Position integration: x = x + v * dt
-        obj->position.x += obj->velocity.x * dt;
-        obj->position.y += obj->velocity.y * dt;
-        obj->position.z += obj->velocity.z * dt;
-        
+        // Every band steps on the same updates, so touching bodies of one
+        // band step together and the slower bands' updates nest inside the
+        // faster ones'
+        uint32_t period = 1u << band;
+        bodies.lodElapsed[i] += dt;
+        if ((lodStep & (period - 1)) == 0) {
+            bodyDt[i] = bodies.lodElapsed[i];
+            bodies.lodElapsed[i] = 0.0f;
+            lodParked[i] = 0u;
+        } else {
+            bodyDt[i] = 0.0f;
+            lodParked[i] = ~0u;
+            counts[LOD_BAND_COUNT]++;
+        }
     }
-    
-    checkCollisions(dt);
 }
 
-void PhysicsEngine::checkCollisions(float dt) {
-    // 1. Terrain/Floor Collision
-    for (auto obj : objects) {
-        // Determine ground height at object's XZ position
-        float groundY = 0.0f;
-        if (getTerrainHeight) {
-            groundY = getTerrainHeight(obj->position.x, obj->position.z);
+void PhysicsEngine::collectFastMovers(size_t begin, size_t end) {
+    std::vector<FastMover>& out = chunkFastMovers[begin / INTEGRATE_CHUNK];
+    out.clear();
+    if (!ccdEnabled) return;
+
+    for (size_t i = begin; i < end; ++i) {
+        if (isInactive((int)i)) continue;
+
+        // The kernel just moved the body by exactly v * bodyDt
+        float dt = bodyDt[i];
+        float dx = bodies.velX[i] * dt;
+        float dy = bodies.velY[i] * dt;
+        float dz = bodies.velZ[i] * dt;
+        if (std::abs(dx) <= ccdThreshold * bodies.sizeX[i] &&
+            std::abs(dy) <= ccdThreshold * bodies.sizeY[i] &&
+            std::abs(dz) <= ccdThreshold * bodies.sizeZ[i]) {
+            continue;
         }
 
-        if (obj->position.y - obj->size.y < groundY) {
-            obj->position.y = groundY + obj->size.y;
-            
+        FastMover m;
+        m.body = (int)i;
+        m.startX = bodies.posX[i] - dx;
+        m.startY = bodies.posY[i] - dy;
+        m.startZ = bodies.posZ[i] - dz;
+        out.push_back(m);
+    }
+}
+
+void PhysicsEngine::resolveGround(size_t begin, size_t end) {
+    // Ground height at every body's XZ position in one batched query
+    if (sampleTerrainHeights) {
+        sampleTerrainHeights(&bodies.posX[begin], &bodies.posZ[begin], &groundHeights[begin], end - begin);
+    } else {
+        std::fill(groundHeights.begin() + begin, groundHeights.begin() + end, 0.0f);
+    }
+
+    for (size_t i = begin; i < end; ++i) {
+        if (bodies.isAsleep[i] | lodParked[i]) continue; // Settled on the ground already, or not moved
+
+        float groundY = groundHeights[i];
+
+        if (bodies.posY[i] - bodies.sizeY[i] < groundY) {
+            bodies.posY[i] = groundY + bodies.sizeY[i];
+
             // Bounce with damping, but stop if velocity is tiny
-            float bounceVel = -obj->velocity.y * 0.3f;
+            float bounceVel = -bodies.velY[i] * 0.3f;
             if (std::abs(bounceVel) < 0.5f) {
-                obj->velocity.y = 0.0f; // Stop bouncing
+                bodies.velY[i] = 0.0f; // Stop bouncing
             } else {
-                obj->velocity.y = bounceVel;
+                bodies.velY[i] = bounceVel;
             }
-            
+
             // Apply friction on ground contact
-            obj->velocity.x *= 0.9f;
-            obj->velocity.z *= 0.9f;
+            bodies.velX[i] *= 0.9f;
+            bodies.velZ[i] *= 0.9f;
         }
     }
+}
 
-    // 2. Object vs Object Collision
-    for (size_t i = 0; i < objects.size(); ++i) {
-        for (size_t j = i + 1; j < objects.size(); ++j) {
-            PhysicsObject* a = objects[i];
-            PhysicsObject* b = objects[j];
-            
-            if (a->isStatic && b->isStatic) continue;
+void PhysicsEngine::buildBroadphase() {
+    if (broadphaseMode != BROADPHASE_SPATIAL_HASH) return;
 
-            // AABB Collision Detection
-            if (std::abs(a->position.x - b->position.x) < (a->size.x + b->size.x) &&
-                std::abs(a->position.y - b->position.y) < (a->size.y + b->size.y) &&
-                std::abs(a->position.z - b->position.z) < (a->size.z + b->size.z)) {
-                
-                resolveCollision(a, b);
-            }
+    // Bucket every body by its XZ footprint, then only test bodies sharing
+    // a cell. Static bodies are flagged so the grid never pairs them up.
+    const size_t count = bodies.size();
+    spatialHash.clear((int)count);
+    for (size_t i = 0; i < count; ++i) {
+        spatialHash.insert((int)i,
+                           bodies.posX[i] - bodies.sizeX[i], bodies.posZ[i] - bodies.sizeZ[i],
+                           bodies.posX[i] + bodies.sizeX[i], bodies.posZ[i] + bodies.sizeZ[i],
+                           bodies.isStatic[i] != 0);
+    }
+
+    // Fast bodies cover their whole sweep, so wherever the sweep stops
+    // them they are still in the right cells for the pair search
+    for (const FastMover& m : fastMovers) {
+        int i = m.body;
+        spatialHash.insert(i,
+                           std::min(m.startX, bodies.posX[i]) - bodies.sizeX[i],
+                           std::min(m.startZ, bodies.posZ[i]) - bodies.sizeZ[i],
+                           std::max(m.startX, bodies.posX[i]) + bodies.sizeX[i],
+                           std::max(m.startZ, bodies.posZ[i]) + bodies.sizeZ[i]);
+    }
+    spatialHash.build();
+}
+
+bool PhysicsEngine::sweepHit(const FastMover& m, int target, float& toi) const {
+    const float start[3] = { m.startX, m.startY, m.startZ };
+    const float end[3] = { bodies.posX[m.body], bodies.posY[m.body], bodies.posZ[m.body] };
+    const float other[3] = { bodies.posX[target], bodies.posY[target], bodies.posZ[target] };
+    const float extent[3] = { bodies.sizeX[m.body] + bodies.sizeX[target],
+                              bodies.sizeY[m.body] + bodies.sizeY[target],
+                              bodies.sizeZ[m.body] + bodies.sizeZ[target] };
+
+    // Ray from the start position against the target grown by our
+    // half-extents (slab test); the target is taken where it is now
+    float enter = -1e30f;
+    float exit = 1e30f;
+    for (int k = 0; k < 3; k++) {
+        float rel = start[k] - other[k];
+        float d = end[k] - start[k];
+        if (d == 0.0f) {
+            if (std::abs(rel) >= extent[k]) return false;
+            continue;
         }
+        float t0 = (-extent[k] - rel) / d;
+        float t1 = (extent[k] - rel) / d;
+        if (t0 > t1) std::swap(t0, t1);
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
     }
+
+    // Already overlapping at the start is the discrete solver's job
+    if (enter < 0.0f || enter >= exit || enter >= 1.0f) return false;
+    toi = enter;
+    return true;
 }
 
-void PhysicsEngine::resolveCollision(PhysicsObject* a, PhysicsObject* b) {
-    // Calculate overlap on each axis
-    float overlapX = (a->size.x + b->size.x) - std::abs(a->position.x - b->position.x);
-    float overlapY = (a->size.y + b->size.y) - std::abs(a->position.y - b->position.y);
-    float overlapZ = (a->size.z + b->size.z) - std::abs(a->position.z - b->position.z);
-
-    // Find the smallest overlap (shallowest penetration) to resolve
-    // Find the smallest overlap (shallowest penetration) to resolve
-    
-    // If 'b' is static, 'a' moves full overlap
-    if (b->isStatic) {
-        if (overlapX < overlapY && overlapX < overlapZ) {
-            a->position.x += (a->position.x < b->position.x) ? -overlapX : overlapX;
-            a->velocity.x = 0.0f; // Slide/Stop, don't bounce
-        } else if (overlapY < overlapX && overlapY < overlapZ) {
-            a->position.y += (a->position.y < b->position.y) ? -overlapY : overlapY;
-            a->velocity.y = 0.0f;
+void PhysicsEngine::sweepFastMovers() {
+    const float CCD_SKIN = 0.01f; // Penetration left so the pair search picks up the contact
+    const size_t count = bodies.size();
+    stats.fastBodies = (int)fastMovers.size();
+    stats.ccdClamps = 0;
+
+    // Serial and in body order: there are few fast movers, and a clamped
+    // body is the target of later sweeps at its clamped position
+    for (const FastMover& m : fastMovers) {
+        int a = m.body;
+        float bestToi = 1.0f;
+        int hit = -1;
+
+        if (broadphaseMode == BROADPHASE_SPATIAL_HASH) {
+            ccdCandidates.clear();
+            spatialHash.queryNeighbours(a, ccdCandidates);
+            for (int j : ccdCandidates) {
+                float toi;
+                if (layersCollide(a, j) && sweepHit(m, j, toi) && toi < bestToi) {
+                    bestToi = toi;
+                    hit = j;
+                }
+            }
         } else {
-            a->position.z += (a->position.z < b->position.z) ? -overlapZ : overlapZ;
-            a->velocity.z = 0.0f;
+            for (size_t j = 0; j < count; ++j) {
+                float toi;
+                if ((int)j != a && layersCollide(a, (int)j) && sweepHit(m, (int)j, toi) && toi < bestToi) {
+                    bestToi = toi;
+                    hit = (int)j;
+                }
+            }
         }
-        return;
+        if (hit < 0) continue;
+
+        float dx = bodies.posX[a] - m.startX;
+        float dy = bodies.posY[a] - m.startY;
+        float dz = bodies.posZ[a] - m.startZ;
+        float length = std::sqrt(dx * dx + dy * dy + dz * dz);
+        float t = std::min(1.0f, bestToi + CCD_SKIN / length);
+
+        bodies.posX[a] = m.startX + dx * t;
+        bodies.posY[a] = m.startY + dy * t;
+        bodies.posZ[a] = m.startZ + dz * t;
+        stats.ccdClamps++;
     }
-    
-    // If 'a' is static (shouldn't happen with current loop order if we check effectively, 
-    // but useful for completeness), 'b' moves full overlap
-    if (a->isStatic) {
-        if (overlapX < overlapY && overlapX < overlapZ) {
-            b->position.x += (b->position.x < a->position.x) ? overlapX : -overlapX; // Push b away
-            b->velocity.x = 0.0f;
-        } else if (overlapY < overlapX && overlapY < overlapZ) {
-            b->position.y += (b->position.y < a->position.y) ? overlapY : -overlapY;
-            b->velocity.y = 0.0f;
-        } else {
-            b->position.z += (b->position.z < a->position.z) ? overlapZ : -overlapZ;
-            b->velocity.z = 0.0f;
+}
+
+void PhysicsEngine::findPairs() {
+    const size_t count = bodies.size();
+
+    dynamicBodies.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (!bodies.isStatic[i]) dynamicBodies.push_back((int)i);
+    }
+
+    size_t chunks = (count + PAIR_CHUNK - 1) / PAIR_CHUNK;
+    if (pairChunks.size() < chunks) pairChunks.resize(chunks);
+
+    // A static body is only paired with dynamic ones: static-static pairs
+    // are never enumerated, in either broadphase
+    workerPool.parallelFor(count, PAIR_CHUNK, [this, count](size_t begin, size_t end) {
+        PairChunk& chunk = pairChunks[begin / PAIR_CHUNK];
+        chunk.pairs.clear();
+        chunk.rejected = 0;
+
+        // The SIMD filter keeps the AABB-overlapping candidates of each row,
+        // in candidate order, for the narrowphase to confirm
+        PhysicsKernels::PairCounts counts = { 0, 0 };
+        for (size_t i = begin; i < end; ++i) {
+            size_t hits;
+            if (broadphaseMode == BROADPHASE_SPATIAL_HASH) {
+                chunk.candidates.clear();
+                spatialHash.queryCandidates((int)i, chunk.candidates);
+                chunk.overlapping.resize(chunk.candidates.size());
+                hits = PhysicsKernels::overlapList(bodies, lodParked.data(), (int)i, chunk.candidates.data(),
+                                                   chunk.candidates.size(), chunk.overlapping.data(), counts);
+            } else if (bodies.isStatic[i]) {
+                size_t first = std::upper_bound(dynamicBodies.begin(), dynamicBodies.end(), (int)i) -
+                               dynamicBodies.begin();
+                size_t n = dynamicBodies.size() - first;
+                chunk.overlapping.resize(n);
+                hits = PhysicsKernels::overlapList(bodies, lodParked.data(), (int)i, dynamicBodies.data() + first, n,
+                                                   chunk.overlapping.data(), counts);
+            } else {
+                chunk.overlapping.resize(count - i - 1);
+                hits = PhysicsKernels::overlapRange(bodies, lodParked.data(), (int)i, (int)i + 1, (int)count,
+                                                    chunk.overlapping.data(), counts);
+            }
+            for (size_t k = 0; k < hits; ++k) {
+                acceptPair((int)i, chunk.overlapping[k], chunk);
+            }
         }
+        chunk.filtered = counts.filtered;
+        chunk.tested = counts.tested;
+    });
+
+    // Chunks cover ascending body ranges, so concatenation keeps (i, j) order
+    pairs.clear();
+    stats.pairsFiltered = 0;
+    stats.pairsTested = 0;
+    stats.pairsRejected = 0;
+    for (size_t c = 0; c < chunks; ++c) {
+        pairs.insert(pairs.end(), pairChunks[c].pairs.begin(), pairChunks[c].pairs.end());
+        stats.pairsFiltered += pairChunks[c].filtered;
+        stats.pairsTested += pairChunks[c].tested;
+        stats.pairsRejected += pairChunks[c].rejected;
+    }
+}
+
+bool PhysicsEngine::shapesIntersect(int a, int b) const {
+    Narrowphase::Collider ca = { bodies.shape[a], { bodies.posX[a], bodies.posY[a], bodies.posZ[a] },
+                                 { bodies.sizeX[a], bodies.sizeY[a], bodies.sizeZ[a] } };
+    Narrowphase::Collider cb = { bodies.shape[b], { bodies.posX[b], bodies.posY[b], bodies.posZ[b] },
+                                 { bodies.sizeX[b], bodies.sizeY[b], bodies.sizeZ[b] } };
+    return Narrowphase::intersect(ca, cb);
+}
+
+void PhysicsEngine::acceptPair(int a, int b, PairChunk& chunk) const {
+    // The AABB test was exact for box pairs; round shapes only touch in part of their boxes
+    if ((bodies.shape[a] != COLLISION_BOX || bodies.shape[b] != COLLISION_BOX) && !shapesIntersect(a, b)) {
+        chunk.rejected++;
         return;
     }
+    chunk.pairs.push_back(ContactPair(a, b));
+}
 
-    // Both dynamic
-    if (overlapX < overlapY && overlapX < overlapZ) {
-        // Resolve on X axis
-        if (a->position.x < b->position.x) {
-            a->position.x -= overlapX * 0.5f;
-            b->position.x += overlapX * 0.5f;
-        } else {
-            a->position.x += overlapX * 0.5f;
-            b->position.x -= overlapX * 0.5f;
-        }
-        // Swap/Reflect velocities
-        float temp = a->velocity.x;
-        a->velocity.x = b->velocity.x;
-        b->velocity.x = temp;
-    } else if (overlapY < overlapX && overlapY < overlapZ) {
-        // Resolve on Y axis
-        if (a->position.y < b->position.y) {
-            a->position.y -= overlapY * 0.5f;
-            b->position.y += overlapY * 0.5f;
-        } else {
-            a->position.y += overlapY * 0.5f;
-            b->position.y -= overlapY * 0.5f;
+void PhysicsEngine::wakeTouchedSleepers() {
+    // A sleeper only shows up in a pair if the other body is awake and
+    // dynamic, so every sleeper found here was hit by something moving
+    for (const ContactPair& p : pairs) {
+        if (bodies.isAsleep[p.a]) wake(p.a);
+        if (bodies.isAsleep[p.b]) wake(p.b);
+    }
+}
+
+namespace {
+
+// Orders body pairs by (a, b) handle, generations included, so a
+// recycled slot never matches the contact of the body that used to own it
+bool handlePairLess(PhysicsHandle xa, PhysicsHandle xb, PhysicsHandle ya, PhysicsHandle yb) {
+    if (xa.index != ya.index) return xa.index < ya.index;
+    if (xb.index != yb.index) return xb.index < yb.index;
+    if (xa.generation != ya.generation) return xa.generation < ya.generation;
+    return xb.generation < yb.generation;
+}
+
+bool contactKeyLess(const PhysicsContact& x, const PhysicsContact& y) {
+    return handlePairLess(x.a, x.b, y.a, y.b);
+}
+
+} // namespace
+
+void PhysicsEngine::setContactsEnabled(bool enabled) {
+    contactsEnabled = enabled;
+    contactsPrevious.clear();
+    contactEvents.clear();
+}
+
+void PhysicsEngine::measureContacts() {
+    contactsFound.resize(contactsEnabled ? pairs.size() : 0);
+    if (!contactsEnabled) return;
+
+    // Positions and velocities are still untouched by the solver here
+    workerPool.parallelFor(pairs.size(), PAIR_CHUNK * 8, [this](size_t begin, size_t end) {
+        const float* vel[3] = { bodies.velX.data(), bodies.velY.data(), bodies.velZ.data() };
+
+        for (size_t k = begin; k < end; ++k) {
+            int a = pairs[k].a;
+            int b = pairs[k].b;
+            uint32_t slotA = bodies.slots[a];
+            uint32_t slotB = bodies.slots[b];
+            if (slotB < slotA) {
+                std::swap(a, b);
+                std::swap(slotA, slotB);
+            }
+
+            // Same normal the solver will use
+            float penetration, sign;
+            int axis = contactAxis(a, b, penetration, sign);
+
+            PhysicsContact& c = contactsFound[k];
+            c.a = PhysicsHandle(slotA, slots[slotA].generation);
+            c.b = PhysicsHandle(slotB, slots[slotB].generation);
+            float n[3] = { 0.0f, 0.0f, 0.0f };
+            n[axis] = sign;
+            c.normal = Vector3(n[0], n[1], n[2]);
+            c.penetration = penetration;
+            c.relativeVelocity = Vector3(vel[0][b] - vel[0][a], vel[1][b] - vel[1][a], vel[2][b] - vel[2][a]);
+            c.state = CONTACT_BEGIN;
         }
-        // Swap/Reflect
-        float temp = a->velocity.y;
-        a->velocity.y = b->velocity.y;
-        b->velocity.y = temp;
-    } else {
-        // Resolve on Z axis
-        if (a->position.z < b->position.z) {
-            a->position.z -= overlapZ * 0.5f;
-            b->position.z += overlapZ * 0.5f;
-        } else {
-            a->position.z += overlapZ * 0.5f;
-            b->position.z -= overlapZ * 0.5f;
+    });
+
+    std::sort(contactsFound.begin(), contactsFound.end(), contactKeyLess);
+}
+
+void PhysicsEngine::classifyContacts() {
+    contactEvents.clear();
+    contactsActive.clear();
+    if (!contactsEnabled) return;
+
+    // Merge this step's contacts with last step's touching set
+    size_t i = 0, j = 0;
+    while (i < contactsFound.size() || j < contactsPrevious.size()) {
+        bool takeFound = j == contactsPrevious.size() ||
+                         (i < contactsFound.size() && !contactKeyLess(contactsPrevious[j], contactsFound[i]));
+        if (takeFound) {
+            PhysicsContact c = contactsFound[i++];
+            bool matched = j < contactsPrevious.size() && !contactKeyLess(c, contactsPrevious[j]);
+            if (matched) j++;
+            c.state = matched ? CONTACT_PERSIST : CONTACT_BEGIN;
+            contactsActive.push_back(c);
+            contactEvents.push_back(c);
+            continue;
         }
-        // Swap/Reflect
-        float temp = a->velocity.z;
-        a->velocity.z = b->velocity.z;
-        b->velocity.z = temp;
+
+        // Not found this step. Pairs of resting bodies are not tested at
+        // all, so a contact whose bodies are both asleep (or static) is
+        // still there; anything else has separated or lost a body.
+        PhysicsContact c = contactsPrevious[j++];
+        int a = indexOf(c.a);
+        int b = indexOf(c.b);
+        bool resting = a >= 0 && b >= 0 && isInactive(a) && isInactive(b) &&
+                       !(bodies.isStatic[a] && bodies.isStatic[b]);
+        c.state = resting ? CONTACT_PERSIST : CONTACT_END;
+        if (resting) contactsActive.push_back(c);
+        contactEvents.push_back(c);
+    }
+
+    contactsPrevious.swap(contactsActive);
+}
+
+int PhysicsEngine::findRoot(int i) {
+    while (islandParent[i] != i) {
+        islandParent[i] = islandParent[islandParent[i]]; // Path halving
+        i = islandParent[i];
+    }
+    return i;
+}
+
+void PhysicsEngine::buildIslands() {
+    const size_t count = bodies.size();
+
+    // Union-find over dynamic bodies in contact. Static bodies never move
+    // during resolution, so they do not join (and merge) islands. One
+    // static body can therefore sit in contacts of several islands that
+    // are solved in parallel; solveIsland only ever reads its state.
+    islandParent.resize(count);
+    for (size_t i = 0; i < count; ++i) islandParent[i] = (int)i;
+
+    for (const ContactPair& p : pairs) {
+        if (bodies.isStatic[p.a] || bodies.isStatic[p.b]) continue;
+        int ra = findRoot(p.a);
+        int rb = findRoot(p.b);
+        if (ra == rb) continue;
+        // Lower index wins, so roots do not depend on visiting order
+        if (ra < rb) islandParent[rb] = ra;
+        else islandParent[ra] = rb;
+    }
+
+    // Number islands by first appearance in the pair list
+    islandOfRoot.assign(count, -1);
+    pairIsland.resize(pairs.size());
+    int islandCount = 0;
+    for (size_t k = 0; k < pairs.size(); ++k) {
+        const ContactPair& p = pairs[k];
+        int root = findRoot(bodies.isStatic[p.a] ? p.b : p.a);
+        if (islandOfRoot[root] < 0) islandOfRoot[root] = islandCount++;
+        pairIsland[k] = islandOfRoot[root];
+    }
+
+    // Stable counting sort of pairs by island
+    islandStart.assign(islandCount + 1, 0);
+    for (size_t k = 0; k < pairs.size(); ++k) islandStart[pairIsland[k] + 1]++;
+    for (int i = 0; i < islandCount; ++i) islandStart[i + 1] += islandStart[i];
+
+    islandPairs.resize(pairs.size());
+    islandCursor.assign(islandStart.begin(), islandStart.end() - 1);
+    for (size_t k = 0; k < pairs.size(); ++k) {
+        islandPairs[islandCursor[pairIsland[k]]++] = pairs[k];
+    }
+
+    // Dynamic bodies of each island, same counting sort
+    islandBodyStart.assign(islandCount + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        if (bodies.isStatic[i]) continue;
+        int island = islandOfRoot[findRoot((int)i)];
+        if (island >= 0) islandBodyStart[island + 1]++;
+    }
+    for (int i = 0; i < islandCount; ++i) islandBodyStart[i + 1] += islandBodyStart[i];
+
+    islandBodies.resize(islandBodyStart[islandCount]);
+    islandCursor.assign(islandBodyStart.begin(), islandBodyStart.end() - 1);
+    for (size_t i = 0; i < count; ++i) {
+        if (bodies.isStatic[i]) continue;
+        int island = islandOfRoot[findRoot((int)i)];
+        if (island >= 0) islandBodies[islandCursor[island]++] = (int)i;
+    }
+
+    stats.islands = islandCount;
+}
+
+namespace {
+
+const float CONTACT_SLOP = 0.005f;         // Overlap left in place so resting contacts persist
+const float POSITION_CORRECTION = 0.8f;    // Share of the remaining overlap pushed out per step
+const float RESTITUTION_THRESHOLD = 1.0f;  // Slower impacts do not bounce
+
+} // namespace
+
+bool PhysicsEngine::cacheKeyLess(const CachedImpulse& x, const CachedImpulse& y) {
+    return handlePairLess(x.a, x.b, y.a, y.b);
+}
+
+int PhysicsEngine::contactAxis(int a, int b, float& penetration, float& sign) const {
+    const float* pos[3] = { bodies.posX.data(), bodies.posY.data(), bodies.posZ.data() };
+    const float* size[3] = { bodies.sizeX.data(), bodies.sizeY.data(), bodies.sizeZ.data() };
+
+    // Calculate overlap on each axis
+    float overlap[3];
+    for (int k = 0; k < 3; k++) {
+        overlap[k] = (size[k][a] + size[k][b]) - std::abs(pos[k][a] - pos[k][b]);
+    }
+
+    // The smallest overlap (shallowest penetration) is the contact normal
+    int axis = 2;
+    if (overlap[0] < overlap[1] && overlap[0] < overlap[2]) {
+        axis = 0;
+    } else if (overlap[1] < overlap[0] && overlap[1] < overlap[2]) {
+        axis = 1;
+    }
+    penetration = overlap[axis];
+    sign = (pos[axis][b] < pos[axis][a]) ? -1.0f : 1.0f;
+    return axis;
+}
+
+void PhysicsEngine::solveIslands() {
+    const size_t islandCount = (size_t)stats.islands;
+    islandIterations.assign(islandCount, 0);
+    solverContacts.resize(islandPairs.size());
+    impulseCacheNext.resize(islandPairs.size());
+
+    workerPool.parallelFor(islandCount, ISLAND_CHUNK, [this](size_t begin, size_t end) {
+        for (size_t island = begin; island < end; ++island) solveIsland((int)island);
+    });
+
+    stats.pairsColliding = (int)islandPairs.size();
+    stats.solverIterations = 0;
+    for (size_t island = 0; island < islandCount; ++island) {
+        stats.solverIterations += islandIterations[island];
+    }
+
+    // Contacts of parked bodies were not tested this step; keep their
+    // impulses for the step they are next due
+    if (lodEnabled) {
+        for (const CachedImpulse& c : impulseCache) {
+            int a = indexOf(c.a);
+            int b = indexOf(c.b);
+            if (a >= 0 && b >= 0 && (lodParked[a] | lodParked[b]) && isInactive(a) && isInactive(b)) {
+                impulseCacheNext.push_back(c);
+            }
+        }
+    }
+
+    // This step's impulses warm start the next one
+    std::sort(impulseCacheNext.begin(), impulseCacheNext.end(), cacheKeyLess);
+    impulseCache.swap(impulseCacheNext);
+}
+
+// Boxes do not rotate, so every contact is a single row along one world
+// axis plus two friction rows along the others, and the effective mass
+// of all three is the reduced mass of the pair.
+void PhysicsEngine::solveIsland(int island) {
+    float* pos[3] = { bodies.posX.data(), bodies.posY.data(), bodies.posZ.data() };
+    float* vel[3] = { bodies.velX.data(), bodies.velY.data(), bodies.velZ.data() };
+    const float* size[3] = { bodies.sizeX.data(), bodies.sizeY.data(), bodies.sizeZ.data() };
+    const int first = islandStart[island];
+    const int last = islandStart[island + 1];
+    const int firstBody = islandBodyStart[island];
+    const int lastBody = islandBodyStart[island + 1];
+
+    // Set up the rows and apply last step's impulses (warm start)
+    for (int k = first; k < last; ++k) {
+        SolverContact& c = solverContacts[k];
+        c.a = islandPairs[k].a;
+        c.b = islandPairs[k].b;
+        if (bodies.slots[c.b] < bodies.slots[c.a]) std::swap(c.a, c.b);
+
+        float penetration;
+        c.axis = contactAxis(c.a, c.b, penetration, c.sign);
+        c.invMassA = (bodies.isStatic[c.a] || bodies.mass[c.a] <= 0.0f) ? 0.0f : 1.0f / bodies.mass[c.a];
+        c.invMassB = (bodies.isStatic[c.b] || bodies.mass[c.b] <= 0.0f) ? 0.0f : 1.0f / bodies.mass[c.b];
+        float invMassSum = c.invMassA + c.invMassB;
+        c.effectiveMass = invMassSum > 0.0f ? 1.0f / invMassSum : 0.0f;
+        c.friction = std::sqrt(bodies.friction[c.a] * bodies.friction[c.b]);
+
+        float approach = (vel[c.axis][c.b] - vel[c.axis][c.a]) * c.sign;
+        float restitution = std::max(bodies.restitution[c.a], bodies.restitution[c.b]);
+        c.bias = (approach < -RESTITUTION_THRESHOLD) ? -restitution * approach : 0.0f;
+
+        CachedImpulse key;
+        key.a = PhysicsHandle(bodies.slots[c.a], slots[bodies.slots[c.a]].generation);
+        key.b = PhysicsHandle(bodies.slots[c.b], slots[bodies.slots[c.b]].generation);
+        auto cached = std::lower_bound(impulseCache.begin(), impulseCache.end(), key, cacheKeyLess);
+        bool warm = cached != impulseCache.end() && !cacheKeyLess(key, *cached) &&
+                    cached->axis == c.axis && cached->sign == c.sign;
+        c.normalImpulse = warm ? cached->normal : 0.0f;
+        c.tangentImpulse[0] = warm ? cached->tangent[0] : 0.0f;
+        c.tangentImpulse[1] = warm ? cached->tangent[1] : 0.0f;
+
+        // A side with no inverse mass is static and may be shared with
+        // other islands solved at the same time: it is only ever read
+        if (c.invMassA != 0.0f) {
+            vel[c.axis][c.a] -= c.sign * c.normalImpulse * c.invMassA;
+            for (int t = 0; t < 2; t++) vel[(c.axis + 1 + t) % 3][c.a] -= c.tangentImpulse[t] * c.invMassA;
+        }
+        if (c.invMassB != 0.0f) {
+            vel[c.axis][c.b] += c.sign * c.normalImpulse * c.invMassB;
+            for (int t = 0; t < 2; t++) vel[(c.axis + 1 + t) % 3][c.b] += c.tangentImpulse[t] * c.invMassB;
+        }
+
+        impulseCacheNext[k] = key;
+    }
+
+    // Bodies resting on the terrain take part as well, so a stack can
+    // push its bottom body into the ground and be held up by it
+    for (int k = firstBody; k < lastBody; ++k) {
+        int i = islandBodies[k];
+        if (pos[1][i] - size[1][i] > groundHeights[i] + CONTACT_SLOP) bodies.groundImpulse[i] = 0.0f;
+        vel[1][i] += bodies.groundImpulse[i];
+    }
+
+    // Sequential impulses: each row clamps its accumulated impulse and
+    // applies only the change, until a sweep barely moves anything
+    int iteration = 0;
+    while (iteration < solverIterations) {
+        float maxChange = 0.0f;
+
+        for (int k = first; k < last; ++k) {
+            SolverContact& c = solverContacts[k];
+            if (c.effectiveMass == 0.0f) continue;
+
+            // Normal: push apart, never pull together
+            float vn = (vel[c.axis][c.b] - vel[c.axis][c.a]) * c.sign;
+            float total = std::max(c.normalImpulse + c.effectiveMass * (c.bias - vn), 0.0f);
+            float delta = total - c.normalImpulse;
+            c.normalImpulse = total;
+            if (c.invMassA != 0.0f) vel[c.axis][c.a] -= c.sign * delta * c.invMassA;
+            if (c.invMassB != 0.0f) vel[c.axis][c.b] += c.sign * delta * c.invMassB;
+            maxChange = std::max(maxChange, std::abs(delta) / c.effectiveMass);
+
+            // Friction: oppose sliding, bounded by the normal impulse
+            float limit = c.friction * c.normalImpulse;
+            for (int t = 0; t < 2; t++) {
+                int tangent = (c.axis + 1 + t) % 3;
+                float vt = vel[tangent][c.b] - vel[tangent][c.a];
+                float accumulated = std::min(std::max(c.tangentImpulse[t] - c.effectiveMass * vt, -limit), limit);
+                float change = accumulated - c.tangentImpulse[t];
+                c.tangentImpulse[t] = accumulated;
+                if (c.invMassA != 0.0f) vel[tangent][c.a] -= change * c.invMassA;
+                if (c.invMassB != 0.0f) vel[tangent][c.b] += change * c.invMassB;
+                maxChange = std::max(maxChange, std::abs(change) / c.effectiveMass);
+            }
+        }
+
+        // Terrain rows, in velocity units (the ground does not move)
+        for (int k = firstBody; k < lastBody; ++k) {
+            int i = islandBodies[k];
+            if (pos[1][i] - size[1][i] > groundHeights[i] + CONTACT_SLOP) continue;
+            float total = std::max(bodies.groundImpulse[i] - vel[1][i], 0.0f);
+            float delta = total - bodies.groundImpulse[i];
+            bodies.groundImpulse[i] = total;
+            vel[1][i] += delta;
+            maxChange = std::max(maxChange, std::abs(delta));
+        }
+
+        ++iteration;
+        if (maxChange <= solverTolerance) break;
+    }
+    islandIterations[island] = iteration;
+
+    // Push out the remaining overlap, weighted by inverse mass, with the
+    // same sweep budget. A body held up by the terrain is not pushed down
+    // into it.
+    for (int sweep = 0; sweep < solverIterations; ++sweep) {
+        float maxCorrection = 0.0f;
+        for (int k = first; k < last; ++k) {
+            const SolverContact& c = solverContacts[k];
+            float invMassA = c.invMassA;
+            float invMassB = c.invMassB;
+            if (c.axis == 1) {
+                int below = c.sign > 0.0f ? c.a : c.b;
+                if (pos[1][below] - size[1][below] <= groundHeights[below] + CONTACT_SLOP) {
+                    (below == c.a ? invMassA : invMassB) = 0.0f;
+                }
+            }
+            float invMassSum = invMassA + invMassB;
+            if (invMassSum == 0.0f) continue;
+            float* p = pos[c.axis];
+            float overlap = (size[c.axis][c.a] + size[c.axis][c.b]) - std::abs(p[c.a] - p[c.b]);
+            float correction = std::max(overlap - CONTACT_SLOP, 0.0f) * POSITION_CORRECTION;
+            if (invMassA != 0.0f) p[c.a] -= c.sign * correction * invMassA / invMassSum;
+            if (invMassB != 0.0f) p[c.b] += c.sign * correction * invMassB / invMassSum;
+            maxCorrection = std::max(maxCorrection, correction);
+        }
+        if (maxCorrection <= CONTACT_SLOP) break;
+    }
+
+    // Keep bodies on top of the terrain, and let the island fall asleep
+    // as a whole: one restless body keeps every sleep timer at zero, and
+    // otherwise all timers continue from the lowest so they run out in
+    // the same step instead of waking each other up one by one
+    const float threshold2 = sleepVelocity * sleepVelocity;
+    float timer = std::numeric_limits<float>::max();
+    for (int k = firstBody; k < lastBody; ++k) {
+        int i = islandBodies[k];
+        pos[1][i] = std::max(pos[1][i], groundHeights[i] + size[1][i]);
+        float speed2 = vel[0][i] * vel[0][i] + vel[1][i] * vel[1][i] + vel[2][i] * vel[2][i];
+        bool driven = bodies.accX[i] != 0.0f || bodies.accY[i] != 0.0f || bodies.accZ[i] != 0.0f;
+        timer = (driven || speed2 > threshold2) ? 0.0f : std::min(timer, bodies.sleepTimer[i]);
+    }
+    for (int k = firstBody; k < lastBody; ++k) bodies.sleepTimer[islandBodies[k]] = timer;
+
+    for (int k = first; k < last; ++k) {
+        const SolverContact& c = solverContacts[k];
+        CachedImpulse& cached = impulseCacheNext[k];
+        cached.axis = c.axis;
+        cached.sign = c.sign;
+        cached.normal = c.normalImpulse;
+        cached.tangent[0] = c.tangentImpulse[0];
+        cached.tangent[1] = c.tangentImpulse[1];
+    }
+}
+
+void PhysicsEngine::updateSleep() {
+    const size_t count = bodies.size();
+    size_t chunks = (count + INTEGRATE_CHUNK - 1) / INTEGRATE_CHUNK;
+    chunkAwake.assign(chunks, 0);
+    chunkSleeping.assign(chunks, 0);
+
+    const float threshold2 = sleepVelocity * sleepVelocity;
+    workerPool.parallelFor(count, INTEGRATE_CHUNK, [this, threshold2](size_t begin, size_t end) {
+        size_t chunk = begin / INTEGRATE_CHUNK;
+        for (size_t i = begin; i < end; ++i) {
+            if (bodies.isStatic[i]) continue;
+            if (bodies.isAsleep[i]) {
+                chunkSleeping[chunk]++;
+                continue;
+            }
+            if (lodParked[i]) {
+                chunkAwake[chunk]++; // Judged again on its next step
+                continue;
+            }
+
+            float speed2 = bodies.velX[i] * bodies.velX[i] + bodies.velY[i] * bodies.velY[i] +
+                           bodies.velZ[i] * bodies.velZ[i];
+            bool driven = bodies.accX[i] != 0.0f || bodies.accY[i] != 0.0f || bodies.accZ[i] != 0.0f;
+            if (!sleepEnabled || driven || speed2 > threshold2) {
+                bodies.sleepTimer[i] = 0.0f;
+                chunkAwake[chunk]++;
+                continue;
+            }
+
+            // Slow enough; fall asleep once it has stayed slow for the whole window
+            bodies.sleepTimer[i] += bodyDt[i];
+            if (bodies.sleepTimer[i] >= sleepTime) {
+                bodies.isAsleep[i] = ~0u;
+                bodies.velX[i] = 0.0f;
+                bodies.velY[i] = 0.0f;
+                bodies.velZ[i] = 0.0f;
+                chunkSleeping[chunk]++;
+            } else {
+                chunkAwake[chunk]++;
+            }
+        }
+    });
+
+    stats.awakeBodies = 0;
+    stats.sleepingBodies = 0;
+    for (size_t c = 0; c < chunks; ++c) {
+        stats.awakeBodies += chunkAwake[c];
+        stats.sleepingBodies += chunkSleeping[c];
     }
 }
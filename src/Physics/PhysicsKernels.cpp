@@ -0,0 +1,678 @@
+#include "Physics/PhysicsKernels.h"
+#include <cmath>
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PHYSICS_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const float GRAVITY = -15.0f;   // Gravity acceleration (units/s^2)
+const float MAX_SPEED = 50.0f;  // Horizontal speed cap while accelerating
+const float STOP_SPEED = 0.01f; // Coasting bodies slower than this are stopped
+
+PhysicsKernels::SimdLevel activeLevel = PhysicsKernels::detectSimdLevel();
+
+// ================================================================
+// Scalar reference implementation
+// ================================================================
+inline void integrateOne(PhysicsBodyStore& b, size_t i, float dt) {
+    // Static, sleeping and parked (dt = 0) bodies are not integrated
+    if ((b.isStatic[i] | b.isAsleep[i]) || dt == 0.0f) return;
+
+    // Apply gravity and user acceleration (WASD input)
+    float vx = b.velX[i] + b.accX[i] * dt;
+    float vy = b.velY[i] + GRAVITY * dt;
+    float vz = b.velZ[i] + b.accZ[i] * dt;
+
+    // Decouple friction: only apply when NOT accelerating
+    bool isAccelerating = (b.accX[i] != 0.0f || b.accZ[i] != 0.0f);
+    if (isAccelerating) {
+        // Cap horizontal speed
+        float horizSpeed = std::sqrt(vx * vx + vz * vz);
+        if (horizSpeed > MAX_SPEED) {
+            float scale = MAX_SPEED / horizSpeed;
+            vx *= scale;
+            vz *= scale;
+        }
+    } else if (b.friction[i] > 0.0f) {
+        float damping = 1.0f - b.friction[i] * dt;
+        if (damping < 0.0f) damping = 0.0f;
+        vx *= damping;
+        vz *= damping;
+
+        // Stop horizontal movement if very slow
+        float horizSpeed = std::sqrt(vx * vx + vz * vz);
+        if (horizSpeed < STOP_SPEED) {
+            vx = 0.0f;
+            vz = 0.0f;
+        }
+    }
+
+    b.velX[i] = vx;
+    b.velY[i] = vy;
+    b.velZ[i] = vz;
+
+    // Position integration: x = x + v * dt
+    b.posX[i] += vx * dt;
+    b.posY[i] += vy * dt;
+    b.posZ[i] += vz * dt;
+}
+
+void integrateScalar(PhysicsBodyStore& b, size_t begin, size_t end, const float* dt) {
+    for (size_t i = begin; i < end; i++) {
+        integrateOne(b, i, dt[i]);
+    }
+}
+
+inline float sampleOne(const PhysicsKernels::Heightfield& f, float x, float z) {
+    const float invCell = 1.0f / f.cellSize;
+    const float maxCoord = (float)f.res;
+    const float lastCell = (float)(f.res - 1);
+    const int stride = f.res + 1;
+
+    // Grid coordinates, clamped onto the field. The operand order matches
+    // _mm_max_ps(v, 0) / _mm_min_ps(v, max), which return the bound for NaN,
+    // so a NaN position samples the edge like the SIMD paths do
+    float fx = std::min(maxCoord, std::max(0.0f, (x - f.origin) * invCell));
+    float fz = std::min(maxCoord, std::max(0.0f, (z - f.origin) * invCell));
+
+    // Cell index; the far edge belongs to the last cell
+    int ix = (int)std::min(lastCell, fx);
+    int iz = (int)std::min(lastCell, fz);
+    float tx = fx - (float)ix;
+    float tz = fz - (float)iz;
+
+    const float* row0 = f.heights + iz * stride + ix;
+    const float* row1 = row0 + stride;
+    float h0 = row0[0] + (row0[1] - row0[0]) * tx;
+    float h1 = row1[0] + (row1[1] - row1[0]) * tx;
+    return h0 + (h1 - h0) * tz;
+}
+
+void sampleScalar(const PhysicsKernels::Heightfield& f, const float* x, const float* z, float* out,
+                  size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        out[i] = sampleOne(f, x[i], z[i]);
+    }
+}
+
+uint32_t slabScalar(const PhysicsKernels::RayPacket& r, const float bmin[3], const float bmax[3],
+                    const float* tMax, float* tEntry) {
+    uint32_t hits = 0;
+    for (int k = 0; k < PhysicsKernels::RAY_PACKET_SIZE; k++) {
+        float x0 = (bmin[0] - r.originX[k]) * r.invDirX[k], x1 = (bmax[0] - r.originX[k]) * r.invDirX[k];
+        float y0 = (bmin[1] - r.originY[k]) * r.invDirY[k], y1 = (bmax[1] - r.originY[k]) * r.invDirY[k];
+        float z0 = (bmin[2] - r.originZ[k]) * r.invDirZ[k], z1 = (bmax[2] - r.originZ[k]) * r.invDirZ[k];
+        float enter = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), 0.0f));
+        float exit = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::max(z0, z1));
+        tEntry[k] = enter;
+        if (enter <= exit && enter <= tMax[k]) hits |= 1u << k;
+    }
+    return hits;
+}
+
+// Body 'a' of the pair filter, loaded once per row
+struct PairTarget {
+    float px, py, pz;
+    float sx, sy, sz;
+    uint32_t category;
+    uint32_t mask;
+    bool inactive;
+};
+
+PairTarget pairTarget(const PhysicsBodyStore& b, const uint32_t* parked, int a) {
+    PairTarget t;
+    t.px = b.posX[a]; t.py = b.posY[a]; t.pz = b.posZ[a];
+    t.sx = b.sizeX[a]; t.sy = b.sizeY[a]; t.sz = b.sizeZ[a];
+    t.category = b.category[a];
+    t.mask = b.mask[a];
+    t.inactive = (b.isStatic[a] | b.isAsleep[a] | parked[a]) != 0;
+    return t;
+}
+
+inline bool overlapOne(const PhysicsBodyStore& b, const uint32_t* parked, const PairTarget& t, int j,
+                       PhysicsKernels::PairCounts& counts) {
+    if (t.inactive && (b.isStatic[j] | b.isAsleep[j] | parked[j])) return false;
+    if (!(t.category & b.mask[j]) || !(b.category[j] & t.mask)) {
+        counts.filtered++;
+        return false;
+    }
+    counts.tested++;
+    return std::abs(t.px - b.posX[j]) < (t.sx + b.sizeX[j]) &&
+           std::abs(t.py - b.posY[j]) < (t.sy + b.sizeY[j]) &&
+           std::abs(t.pz - b.posZ[j]) < (t.sz + b.sizeZ[j]);
+}
+
+size_t overlapRangeScalar(const PhysicsBodyStore& b, const uint32_t* parked, const PairTarget& t, int first,
+                          int end, int* out, PhysicsKernels::PairCounts& counts) {
+    size_t n = 0;
+    for (int j = first; j < end; j++) {
+        if (overlapOne(b, parked, t, j, counts)) out[n++] = j;
+    }
+    return n;
+}
+
+size_t overlapListScalar(const PhysicsBodyStore& b, const uint32_t* parked, const PairTarget& t, const int* ids,
+                         size_t count, int* out, PhysicsKernels::PairCounts& counts) {
+    size_t n = 0;
+    for (size_t k = 0; k < count; k++) {
+        if (overlapOne(b, parked, t, ids[k], counts)) out[n++] = ids[k];
+    }
+    return n;
+}
+
+#ifdef PHYSICS_KERNELS_X86
+
+// ================================================================
+// SSE (4 bodies per iteration)
+// ================================================================
+#ifdef __SSE2__
+inline __m128 select128(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+void integrateSSE(PhysicsBodyStore& b, size_t begin, size_t end, const float* dt) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 gravity = _mm_set1_ps(GRAVITY);
+    const __m128 maxSpeed = _mm_set1_ps(MAX_SPEED);
+    const __m128 stopSpeed = _mm_set1_ps(STOP_SPEED);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 vdt = _mm_loadu_ps(&dt[i]);
+        __m128 gdt = _mm_mul_ps(gravity, vdt);
+        __m128 frozen = _mm_castsi128_ps(_mm_or_si128(_mm_loadu_si128((const __m128i*)&b.isStatic[i]),
+                                                      _mm_loadu_si128((const __m128i*)&b.isAsleep[i])));
+        frozen = _mm_or_ps(frozen, _mm_cmpeq_ps(vdt, zero));
+        __m128 ax = _mm_loadu_ps(&b.accX[i]);
+        __m128 az = _mm_loadu_ps(&b.accZ[i]);
+        __m128 vx0 = _mm_loadu_ps(&b.velX[i]);
+        __m128 vy0 = _mm_loadu_ps(&b.velY[i]);
+        __m128 vz0 = _mm_loadu_ps(&b.velZ[i]);
+        __m128 friction = _mm_loadu_ps(&b.friction[i]);
+
+        __m128 vx = _mm_add_ps(vx0, _mm_mul_ps(ax, vdt));
+        __m128 vy = _mm_add_ps(vy0, gdt);
+        __m128 vz = _mm_add_ps(vz0, _mm_mul_ps(az, vdt));
+
+        // Accelerating lanes: cap horizontal speed
+        __m128 accelerating = _mm_or_ps(_mm_cmpneq_ps(ax, zero), _mm_cmpneq_ps(az, zero));
+        __m128 speed = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vz, vz)));
+        __m128 over = _mm_cmpgt_ps(speed, maxSpeed);
+        __m128 scale = _mm_div_ps(maxSpeed, speed);
+        __m128 vxCap = select128(over, _mm_mul_ps(vx, scale), vx);
+        __m128 vzCap = select128(over, _mm_mul_ps(vz, scale), vz);
+
+        // Coasting lanes with friction: damp, then snap to zero when very slow
+        __m128 hasFriction = _mm_cmpgt_ps(friction, zero);
+        __m128 damping = _mm_max_ps(zero, _mm_sub_ps(one, _mm_mul_ps(friction, vdt)));
+        __m128 vxDamp = _mm_mul_ps(vx, damping);
+        __m128 vzDamp = _mm_mul_ps(vz, damping);
+        __m128 dampSpeed = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vxDamp, vxDamp), _mm_mul_ps(vzDamp, vzDamp)));
+        __m128 stop = _mm_cmplt_ps(dampSpeed, stopSpeed);
+        vxDamp = _mm_andnot_ps(stop, vxDamp);
+        vzDamp = _mm_andnot_ps(stop, vzDamp);
+
+        __m128 vxCoast = select128(hasFriction, vxDamp, vx);
+        __m128 vzCoast = select128(hasFriction, vzDamp, vz);
+        vx = select128(accelerating, vxCap, vxCoast);
+        vz = select128(accelerating, vzCap, vzCoast);
+
+        // Static and sleeping lanes keep their previous state
+        vx = select128(frozen, vx0, vx);
+        vy = select128(frozen, vy0, vy);
+        vz = select128(frozen, vz0, vz);
+        _mm_storeu_ps(&b.velX[i], vx);
+        _mm_storeu_ps(&b.velY[i], vy);
+        _mm_storeu_ps(&b.velZ[i], vz);
+
+        __m128 px = _mm_loadu_ps(&b.posX[i]);
+        __m128 py = _mm_loadu_ps(&b.posY[i]);
+        __m128 pz = _mm_loadu_ps(&b.posZ[i]);
+        _mm_storeu_ps(&b.posX[i], select128(frozen, px, _mm_add_ps(px, _mm_mul_ps(vx, vdt))));
+        _mm_storeu_ps(&b.posY[i], select128(frozen, py, _mm_add_ps(py, _mm_mul_ps(vy, vdt))));
+        _mm_storeu_ps(&b.posZ[i], select128(frozen, pz, _mm_add_ps(pz, _mm_mul_ps(vz, vdt))));
+    }
+
+    integrateScalar(b, i, end, dt);
+}
+
+// Four lanes of the packet starting at 'k'
+uint32_t slabSSE4(const PhysicsKernels::RayPacket& r, int k, const float bmin[3], const float bmax[3],
+                  const float* tMax, float* tEntry) {
+    __m128 x0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bmin[0]), _mm_loadu_ps(&r.originX[k])), _mm_loadu_ps(&r.invDirX[k]));
+    __m128 x1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bmax[0]), _mm_loadu_ps(&r.originX[k])), _mm_loadu_ps(&r.invDirX[k]));
+    __m128 y0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bmin[1]), _mm_loadu_ps(&r.originY[k])), _mm_loadu_ps(&r.invDirY[k]));
+    __m128 y1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bmax[1]), _mm_loadu_ps(&r.originY[k])), _mm_loadu_ps(&r.invDirY[k]));
+    __m128 z0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bmin[2]), _mm_loadu_ps(&r.originZ[k])), _mm_loadu_ps(&r.invDirZ[k]));
+    __m128 z1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bmax[2]), _mm_loadu_ps(&r.originZ[k])), _mm_loadu_ps(&r.invDirZ[k]));
+    __m128 enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(x0, x1), _mm_min_ps(y0, y1)),
+                              _mm_max_ps(_mm_min_ps(z0, z1), _mm_setzero_ps()));
+    __m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(x0, x1), _mm_max_ps(y0, y1)), _mm_max_ps(z0, z1));
+    _mm_storeu_ps(&tEntry[k], enter);
+    __m128 hit = _mm_and_ps(_mm_cmple_ps(enter, exit), _mm_cmple_ps(enter, _mm_loadu_ps(&tMax[k])));
+    return (uint32_t)_mm_movemask_ps(hit) << k;
+}
+
+uint32_t slabSSE(const PhysicsKernels::RayPacket& r, const float bmin[3], const float bmax[3],
+                 const float* tMax, float* tEntry) {
+    return slabSSE4(r, 0, bmin, bmax, tMax, tEntry) | slabSSE4(r, 4, bmin, bmax, tMax, tEntry);
+}
+
+// Candidate columns for four lanes of the pair filter
+struct PairLanes4 {
+    __m128i inactive, category, mask;
+    __m128 px, py, pz, sx, sy, sz;
+};
+
+// Bit k set if lane k overlaps; counts as overlapOne does
+inline uint32_t pairBits4(const PairTarget& t, const PairLanes4& l, PhysicsKernels::PairCounts& counts) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+
+    uint32_t live = t.inactive ? (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(l.inactive, zero))) : 0xFu;
+    __m128i reject = _mm_or_si128(_mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32((int)t.category), l.mask), zero),
+                                  _mm_cmpeq_epi32(_mm_and_si128(l.category, _mm_set1_epi32((int)t.mask)), zero));
+    uint32_t rejected = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(reject));
+    uint32_t tested = live & ~rejected;
+    counts.filtered += __builtin_popcount(live & rejected);
+    counts.tested += __builtin_popcount(tested);
+    if (!tested) return 0;
+
+    __m128 ox = _mm_cmplt_ps(_mm_andnot_ps(signMask, _mm_sub_ps(_mm_set1_ps(t.px), l.px)), _mm_add_ps(_mm_set1_ps(t.sx), l.sx));
+    __m128 oy = _mm_cmplt_ps(_mm_andnot_ps(signMask, _mm_sub_ps(_mm_set1_ps(t.py), l.py)), _mm_add_ps(_mm_set1_ps(t.sy), l.sy));
+    __m128 oz = _mm_cmplt_ps(_mm_andnot_ps(signMask, _mm_sub_ps(_mm_set1_ps(t.pz), l.pz)), _mm_add_ps(_mm_set1_ps(t.sz), l.sz));
+    return tested & (uint32_t)_mm_movemask_ps(_mm_and_ps(ox, _mm_and_ps(oy, oz)));
+}
+
+size_t overlapRangeSSE(const PhysicsBodyStore& b, const uint32_t* parked, const PairTarget& t, int first, int end,
+                       int* out, PhysicsKernels::PairCounts& counts) {
+    size_t n = 0;
+    int j = first;
+    for (; j + 4 <= end; j += 4) {
+        PairLanes4 l;
+        l.inactive = _mm_or_si128(_mm_or_si128(_mm_loadu_si128((const __m128i*)&b.isStatic[j]),
+                                               _mm_loadu_si128((const __m128i*)&b.isAsleep[j])),
+                                  _mm_loadu_si128((const __m128i*)&parked[j]));
+        l.category = _mm_loadu_si128((const __m128i*)&b.category[j]);
+        l.mask = _mm_loadu_si128((const __m128i*)&b.mask[j]);
+        l.px = _mm_loadu_ps(&b.posX[j]); l.py = _mm_loadu_ps(&b.posY[j]); l.pz = _mm_loadu_ps(&b.posZ[j]);
+        l.sx = _mm_loadu_ps(&b.sizeX[j]); l.sy = _mm_loadu_ps(&b.sizeY[j]); l.sz = _mm_loadu_ps(&b.sizeZ[j]);
+        for (uint32_t hits = pairBits4(t, l, counts); hits; hits &= hits - 1) out[n++] = j + __builtin_ctz(hits);
+    }
+    return n + overlapRangeScalar(b, parked, t, j, end, out + n, counts);
+}
+
+size_t overlapListSSE(const PhysicsBodyStore& b, const uint32_t* parked, const PairTarget& t, const int* ids,
+                      size_t count, int* out, PhysicsKernels::PairCounts& counts) {
+    size_t n = 0;
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        // No gather before AVX2: the lanes are filled one by one
+        const int* i = &ids[k];
+        PairLanes4 l;
+        l.inactive = _mm_set_epi32((int)(b.isStatic[i[3]] | b.isAsleep[i[3]] | parked[i[3]]),
+                                   (int)(b.isStatic[i[2]] | b.isAsleep[i[2]] | parked[i[2]]),
+                                   (int)(b.isStatic[i[1]] | b.isAsleep[i[1]] | parked[i[1]]),
+                                   (int)(b.isStatic[i[0]] | b.isAsleep[i[0]] | parked[i[0]]));
+        l.category = _mm_set_epi32((int)b.category[i[3]], (int)b.category[i[2]], (int)b.category[i[1]], (int)b.category[i[0]]);
+        l.mask = _mm_set_epi32((int)b.mask[i[3]], (int)b.mask[i[2]], (int)b.mask[i[1]], (int)b.mask[i[0]]);
+        l.px = _mm_set_ps(b.posX[i[3]], b.posX[i[2]], b.posX[i[1]], b.posX[i[0]]);
+        l.py = _mm_set_ps(b.posY[i[3]], b.posY[i[2]], b.posY[i[1]], b.posY[i[0]]);
+        l.pz = _mm_set_ps(b.posZ[i[3]], b.posZ[i[2]], b.posZ[i[1]], b.posZ[i[0]]);
+        l.sx = _mm_set_ps(b.sizeX[i[3]], b.sizeX[i[2]], b.sizeX[i[1]], b.sizeX[i[0]]);
+        l.sy = _mm_set_ps(b.sizeY[i[3]], b.sizeY[i[2]], b.sizeY[i[1]], b.sizeY[i[0]]);
+        l.sz = _mm_set_ps(b.sizeZ[i[3]], b.sizeZ[i[2]], b.sizeZ[i[1]], b.sizeZ[i[0]]);
+        for (uint32_t hits = pairBits4(t, l, counts); hits; hits &= hits - 1) out[n++] = i[__builtin_ctz(hits)];
+    }
+    return n + overlapListScalar(b, parked, t, ids + k, count - k, out + n, counts);
+}
+
+void sampleSSE(const PhysicsKernels::Heightfield& f, const float* x, const float* z, float* out, size_t count) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 invCell = _mm_set1_ps(1.0f / f.cellSize);
+    const __m128 origin = _mm_set1_ps(f.origin);
+    const __m128 maxCoord = _mm_set1_ps((float)f.res);
+    const __m128 lastCell = _mm_set1_ps((float)(f.res - 1));
+    const int stride = f.res + 1;
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 fx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&x[i]), origin), invCell);
+        __m128 fz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&z[i]), origin), invCell);
+        fx = _mm_min_ps(_mm_max_ps(fx, zero), maxCoord);
+        fz = _mm_min_ps(_mm_max_ps(fz, zero), maxCoord);
+        __m128i ix = _mm_cvttps_epi32(_mm_min_ps(fx, lastCell));
+        __m128i iz = _mm_cvttps_epi32(_mm_min_ps(fz, lastCell));
+        __m128 tx = _mm_sub_ps(fx, _mm_cvtepi32_ps(ix));
+        __m128 tz = _mm_sub_ps(fz, _mm_cvtepi32_ps(iz));
+
+        // No gather before AVX2: fetch the four corners lane by lane
+        alignas(16) int32_t cx[4], cz[4];
+        _mm_store_si128((__m128i*)cx, ix);
+        _mm_store_si128((__m128i*)cz, iz);
+        alignas(16) float h00[4], h10[4], h01[4], h11[4];
+        for (int k = 0; k < 4; k++) {
+            const float* row0 = f.heights + cz[k] * stride + cx[k];
+            h00[k] = row0[0];
+            h10[k] = row0[1];
+            h01[k] = row0[stride];
+            h11[k] = row0[stride + 1];
+        }
+
+        __m128 a = _mm_load_ps(h00), b = _mm_load_ps(h10), c = _mm_load_ps(h01), d = _mm_load_ps(h11);
+        __m128 h0 = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), tx));
+        __m128 h1 = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(d, c), tx));
+        _mm_storeu_ps(&out[i], _mm_add_ps(h0, _mm_mul_ps(_mm_sub_ps(h1, h0), tz)));
+    }
+
+    sampleScalar(f, x, z, out, i, count);
+}
+#endif // __SSE2__
+
+// ================================================================
+// AVX2 (8 bodies per iteration)
+// ================================================================
+__attribute__((target("avx2")))
+void integrateAVX2(PhysicsBodyStore& b, size_t begin, size_t end, const float* dt) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 gravity = _mm256_set1_ps(GRAVITY);
+    const __m256 maxSpeed = _mm256_set1_ps(MAX_SPEED);
+    const __m256 stopSpeed = _mm256_set1_ps(STOP_SPEED);
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 vdt = _mm256_loadu_ps(&dt[i]);
+        __m256 gdt = _mm256_mul_ps(gravity, vdt);
+        __m256 frozen = _mm256_castsi256_ps(_mm256_or_si256(_mm256_loadu_si256((const __m256i*)&b.isStatic[i]),
+                                                            _mm256_loadu_si256((const __m256i*)&b.isAsleep[i])));
+        frozen = _mm256_or_ps(frozen, _mm256_cmp_ps(vdt, zero, _CMP_EQ_OQ));
+        __m256 ax = _mm256_loadu_ps(&b.accX[i]);
+        __m256 az = _mm256_loadu_ps(&b.accZ[i]);
+        __m256 vx0 = _mm256_loadu_ps(&b.velX[i]);
+        __m256 vy0 = _mm256_loadu_ps(&b.velY[i]);
+        __m256 vz0 = _mm256_loadu_ps(&b.velZ[i]);
+        __m256 friction = _mm256_loadu_ps(&b.friction[i]);
+
+        __m256 vx = _mm256_add_ps(vx0, _mm256_mul_ps(ax, vdt));
+        __m256 vy = _mm256_add_ps(vy0, gdt);
+        __m256 vz = _mm256_add_ps(vz0, _mm256_mul_ps(az, vdt));
+
+        // Accelerating lanes: cap horizontal speed
+        __m256 accelerating = _mm256_or_ps(_mm256_cmp_ps(ax, zero, _CMP_NEQ_UQ),
+                                           _mm256_cmp_ps(az, zero, _CMP_NEQ_UQ));
+        __m256 speed = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vz, vz)));
+        __m256 over = _mm256_cmp_ps(speed, maxSpeed, _CMP_GT_OQ);
+        __m256 scale = _mm256_div_ps(maxSpeed, speed);
+        __m256 vxCap = _mm256_blendv_ps(vx, _mm256_mul_ps(vx, scale), over);
+        __m256 vzCap = _mm256_blendv_ps(vz, _mm256_mul_ps(vz, scale), over);
+
+        // Coasting lanes with friction: damp, then snap to zero when very slow
+        __m256 hasFriction = _mm256_cmp_ps(friction, zero, _CMP_GT_OQ);
+        __m256 damping = _mm256_max_ps(zero, _mm256_sub_ps(one, _mm256_mul_ps(friction, vdt)));
+        __m256 vxDamp = _mm256_mul_ps(vx, damping);
+        __m256 vzDamp = _mm256_mul_ps(vz, damping);
+        __m256 dampSpeed = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(vxDamp, vxDamp),
+                                                        _mm256_mul_ps(vzDamp, vzDamp)));
+        __m256 stop = _mm256_cmp_ps(dampSpeed, stopSpeed, _CMP_LT_OQ);
+        vxDamp = _mm256_andnot_ps(stop, vxDamp);
+        vzDamp = _mm256_andnot_ps(stop, vzDamp);
+
+        __m256 vxCoast = _mm256_blendv_ps(vx, vxDamp, hasFriction);
+        __m256 vzCoast = _mm256_blendv_ps(vz, vzDamp, hasFriction);
+        vx = _mm256_blendv_ps(vxCoast, vxCap, accelerating);
+        vz = _mm256_blendv_ps(vzCoast, vzCap, accelerating);
+
+        // Static and sleeping lanes keep their previous state
+        vx = _mm256_blendv_ps(vx, vx0, frozen);
+        vy = _mm256_blendv_ps(vy, vy0, frozen);
+        vz = _mm256_blendv_ps(vz, vz0, frozen);
+        _mm256_storeu_ps(&b.velX[i], vx);
+        _mm256_storeu_ps(&b.velY[i], vy);
+        _mm256_storeu_ps(&b.velZ[i], vz);
+
+        __m256 px = _mm256_loadu_ps(&b.posX[i]);
+        __m256 py = _mm256_loadu_ps(&b.posY[i]);
+        __m256 pz = _mm256_loadu_ps(&b.posZ[i]);
+        _mm256_storeu_ps(&b.posX[i], _mm256_blendv_ps(_mm256_add_ps(px, _mm256_mul_ps(vx, vdt)), px, frozen));
+        _mm256_storeu_ps(&b.posY[i], _mm256_blendv_ps(_mm256_add_ps(py, _mm256_mul_ps(vy, vdt)), py, frozen));
+        _mm256_storeu_ps(&b.posZ[i], _mm256_blendv_ps(_mm256_add_ps(pz, _mm256_mul_ps(vz, vdt)), pz, frozen));
+    }
+
+    integrateScalar(b, i, end, dt);
+}
+
+__attribute__((target("avx2")))
+uint32_t slabAVX2(const PhysicsKernels::RayPacket& r, const float bmin[3], const float bmax[3],
+                  const float* tMax, float* tEntry) {
+    __m256 x0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(bmin[0]), _mm256_loadu_ps(r.originX)), _mm256_loadu_ps(r.invDirX));
+    __m256 x1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(bmax[0]), _mm256_loadu_ps(r.originX)), _mm256_loadu_ps(r.invDirX));
+    __m256 y0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(bmin[1]), _mm256_loadu_ps(r.originY)), _mm256_loadu_ps(r.invDirY));
+    __m256 y1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(bmax[1]), _mm256_loadu_ps(r.originY)), _mm256_loadu_ps(r.invDirY));
+    __m256 z0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(bmin[2]), _mm256_loadu_ps(r.originZ)), _mm256_loadu_ps(r.invDirZ));
+    __m256 z1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(bmax[2]), _mm256_loadu_ps(r.originZ)), _mm256_loadu_ps(r.invDirZ));
+    __m256 enter = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(x0, x1), _mm256_min_ps(y0, y1)),
+                                 _mm256_max_ps(_mm256_min_ps(z0, z1), _mm256_setzero_ps()));
+    __m256 exit = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(x0, x1), _mm256_max_ps(y0, y1)), _mm256_max_ps(z0, z1));
+    _mm256_storeu_ps(tEntry, enter);
+    __m256 hit = _mm256_and_ps(_mm256_cmp_ps(enter, exit, _CMP_LE_OQ),
+                               _mm256_cmp_ps(enter, _mm256_loadu_ps(tMax), _CMP_LE_OQ));
+    return (uint32_t)_mm256_movemask_ps(hit);
+}
+
+// Candidate columns for eight lanes of the pair filter
+struct PairLanes8 {
+    __m256i inactive, category, mask;
+    __m256 px, py, pz, sx, sy, sz;
+};
+
+__attribute__((target("avx2")))
+inline uint32_t pairBits8(const PairTarget& t, const PairLanes8& l, PhysicsKernels::PairCounts& counts) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+    uint32_t live = t.inactive ? (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(l.inactive, zero)))
+                               : 0xFFu;
+    __m256i reject = _mm256_or_si256(
+        _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((int)t.category), l.mask), zero),
+        _mm256_cmpeq_epi32(_mm256_and_si256(l.category, _mm256_set1_epi32((int)t.mask)), zero));
+    uint32_t rejected = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(reject));
+    uint32_t tested = live & ~rejected;
+    counts.filtered += __builtin_popcount(live & rejected);
+    counts.tested += __builtin_popcount(tested);
+    if (!tested) return 0;
+
+    __m256 ox = _mm256_cmp_ps(_mm256_andnot_ps(signMask, _mm256_sub_ps(_mm256_set1_ps(t.px), l.px)),
+                              _mm256_add_ps(_mm256_set1_ps(t.sx), l.sx), _CMP_LT_OQ);
+    __m256 oy = _mm256_cmp_ps(_mm256_andnot_ps(signMask, _mm256_sub_ps(_mm256_set1_ps(t.py), l.py)),
+                              _mm256_add_ps(_mm256_set1_ps(t.sy), l.sy), _CMP_LT_OQ);
+    __m256 oz = _mm256_cmp_ps(_mm256_andnot_ps(signMask, _mm256_sub_ps(_mm256_set1_ps(t.pz), l.pz)),
+                              _mm256_add_ps(_mm256_set1_ps(t.sz), l.sz), _CMP_LT_OQ);
+    return tested & (uint32_t)_mm256_movemask_ps(_mm256_and_ps(ox, _mm256_and_ps(oy, oz)));
+}
+
+__attribute__((target("avx2")))
+size_t overlapRangeAVX2(const PhysicsBodyStore& b, const uint32_t* parked, const PairTarget& t, int first, int end,
+                        int* out, PhysicsKernels::PairCounts& counts) {
+    size_t n = 0;
+    int j = first;
+    for (; j + 8 <= end; j += 8) {
+        PairLanes8 l;
+        l.inactive = _mm256_or_si256(_mm256_or_si256(_mm256_loadu_si256((const __m256i*)&b.isStatic[j]),
+                                                     _mm256_loadu_si256((const __m256i*)&b.isAsleep[j])),
+                                     _mm256_loadu_si256((const __m256i*)&parked[j]));
+        l.category = _mm256_loadu_si256((const __m256i*)&b.category[j]);
+        l.mask = _mm256_loadu_si256((const __m256i*)&b.mask[j]);
+        l.px = _mm256_loadu_ps(&b.posX[j]); l.py = _mm256_loadu_ps(&b.posY[j]); l.pz = _mm256_loadu_ps(&b.posZ[j]);
+        l.sx = _mm256_loadu_ps(&b.sizeX[j]); l.sy = _mm256_loadu_ps(&b.sizeY[j]); l.sz = _mm256_loadu_ps(&b.sizeZ[j]);
+        for (uint32_t hits = pairBits8(t, l, counts); hits; hits &= hits - 1) out[n++] = j + __builtin_ctz(hits);
+    }
+    return n + overlapRangeScalar(b, parked, t, j, end, out + n, counts);
+}
+
+__attribute__((target("avx2")))
+size_t overlapListAVX2(const PhysicsBodyStore& b, const uint32_t* parked, const PairTarget& t, const int* ids,
+                       size_t count, int* out, PhysicsKernels::PairCounts& counts) {
+    size_t n = 0;
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256i idx = _mm256_loadu_si256((const __m256i*)&ids[k]);
+        PairLanes8 l;
+        l.inactive = _mm256_or_si256(
+            _mm256_or_si256(_mm256_i32gather_epi32((const int*)b.isStatic.data(), idx, 4),
+                            _mm256_i32gather_epi32((const int*)b.isAsleep.data(), idx, 4)),
+            _mm256_i32gather_epi32((const int*)parked, idx, 4));
+        l.category = _mm256_i32gather_epi32((const int*)b.category.data(), idx, 4);
+        l.mask = _mm256_i32gather_epi32((const int*)b.mask.data(), idx, 4);
+        l.px = _mm256_i32gather_ps(b.posX.data(), idx, 4);
+        l.py = _mm256_i32gather_ps(b.posY.data(), idx, 4);
+        l.pz = _mm256_i32gather_ps(b.posZ.data(), idx, 4);
+        l.sx = _mm256_i32gather_ps(b.sizeX.data(), idx, 4);
+        l.sy = _mm256_i32gather_ps(b.sizeY.data(), idx, 4);
+        l.sz = _mm256_i32gather_ps(b.sizeZ.data(), idx, 4);
+        for (uint32_t hits = pairBits8(t, l, counts); hits; hits &= hits - 1) out[n++] = ids[k + __builtin_ctz(hits)];
+    }
+    return n + overlapListScalar(b, parked, t, ids + k, count - k, out + n, counts);
+}
+
+__attribute__((target("avx2")))
+void sampleAVX2(const PhysicsKernels::Heightfield& f, const float* x, const float* z, float* out, size_t count) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 invCell = _mm256_set1_ps(1.0f / f.cellSize);
+    const __m256 origin = _mm256_set1_ps(f.origin);
+    const __m256 maxCoord = _mm256_set1_ps((float)f.res);
+    const __m256 lastCell = _mm256_set1_ps((float)(f.res - 1));
+    const __m256i stride = _mm256_set1_epi32(f.res + 1);
+    const __m256i one = _mm256_set1_epi32(1);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 fx = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&x[i]), origin), invCell);
+        __m256 fz = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&z[i]), origin), invCell);
+        fx = _mm256_min_ps(_mm256_max_ps(fx, zero), maxCoord);
+        fz = _mm256_min_ps(_mm256_max_ps(fz, zero), maxCoord);
+        __m256i ix = _mm256_cvttps_epi32(_mm256_min_ps(fx, lastCell));
+        __m256i iz = _mm256_cvttps_epi32(_mm256_min_ps(fz, lastCell));
+        __m256 tx = _mm256_sub_ps(fx, _mm256_cvtepi32_ps(ix));
+        __m256 tz = _mm256_sub_ps(fz, _mm256_cvtepi32_ps(iz));
+
+        __m256i i00 = _mm256_add_epi32(_mm256_mullo_epi32(iz, stride), ix);
+        __m256i i01 = _mm256_add_epi32(i00, stride);
+        __m256 a = _mm256_i32gather_ps(f.heights, i00, 4);
+        __m256 b = _mm256_i32gather_ps(f.heights, _mm256_add_epi32(i00, one), 4);
+        __m256 c = _mm256_i32gather_ps(f.heights, i01, 4);
+        __m256 d = _mm256_i32gather_ps(f.heights, _mm256_add_epi32(i01, one), 4);
+
+        __m256 h0 = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), tx));
+        __m256 h1 = _mm256_add_ps(c, _mm256_mul_ps(_mm256_sub_ps(d, c), tx));
+        _mm256_storeu_ps(&out[i], _mm256_add_ps(h0, _mm256_mul_ps(_mm256_sub_ps(h1, h0), tz)));
+    }
+
+    sampleScalar(f, x, z, out, i, count);
+}
+
+#endif // PHYSICS_KERNELS_X86
+
+} // namespace
+
+namespace PhysicsKernels {
+
+SimdLevel detectSimdLevel() {
+#ifdef PHYSICS_KERNELS_X86
+    // May run from a static initializer, before the CPU model is set up
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+#ifdef __SSE2__
+    return SIMD_SSE;
+#endif
+#endif
+    return SIMD_SCALAR;
+}
+
+void setSimdLevel(SimdLevel level) {
+    SimdLevel best = detectSimdLevel();
+    activeLevel = (level > best) ? best : level;
+}
+
+SimdLevel getSimdLevel() {
+    return activeLevel;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SIMD_AVX2: return "avx2";
+        case SIMD_SSE: return "sse";
+        default: return "scalar";
+    }
+}
+
+void integrate(PhysicsBodyStore& bodies, size_t begin, size_t end, const float* dt) {
+    switch (activeLevel) {
+#ifdef PHYSICS_KERNELS_X86
+        case SIMD_AVX2: integrateAVX2(bodies, begin, end, dt); return;
+#ifdef __SSE2__
+        case SIMD_SSE: integrateSSE(bodies, begin, end, dt); return;
+#endif
+#endif
+        default: integrateScalar(bodies, begin, end, dt); return;
+    }
+}
+
+void sampleHeightfield(const Heightfield& field, const float* x, const float* z, float* out, size_t count) {
+    switch (activeLevel) {
+#ifdef PHYSICS_KERNELS_X86
+        case SIMD_AVX2: sampleAVX2(field, x, z, out, count); return;
+#ifdef __SSE2__
+        case SIMD_SSE: sampleSSE(field, x, z, out, count); return;
+#endif
+#endif
+        default: sampleScalar(field, x, z, out, 0, count); return;
+    }
+}
+
+size_t overlapRange(const PhysicsBodyStore& bodies, const uint32_t* parked, int a, int first, int end,
+                    int* out, PairCounts& counts) {
+    PairTarget t = pairTarget(bodies, parked, a);
+    switch (activeLevel) {
+#ifdef PHYSICS_KERNELS_X86
+        case SIMD_AVX2: return overlapRangeAVX2(bodies, parked, t, first, end, out, counts);
+#ifdef __SSE2__
+        case SIMD_SSE: return overlapRangeSSE(bodies, parked, t, first, end, out, counts);
+#endif
+#endif
+        default: return overlapRangeScalar(bodies, parked, t, first, end, out, counts);
+    }
+}
+
+size_t overlapList(const PhysicsBodyStore& bodies, const uint32_t* parked, int a, const int* ids, size_t count,
+                   int* out, PairCounts& counts) {
+    PairTarget t = pairTarget(bodies, parked, a);
+    switch (activeLevel) {
+#ifdef PHYSICS_KERNELS_X86
+        case SIMD_AVX2: return overlapListAVX2(bodies, parked, t, ids, count, out, counts);
+#ifdef __SSE2__
+        case SIMD_SSE: return overlapListSSE(bodies, parked, t, ids, count, out, counts);
+#endif
+#endif
+        default: return overlapListScalar(bodies, parked, t, ids, count, out, counts);
+    }
+}
+
+uint32_t slabTest(const RayPacket& rays, const float bmin[3], const float bmax[3], const float* tMax, float* tEntry) {
+    switch (activeLevel) {
+#ifdef PHYSICS_KERNELS_X86
+        case SIMD_AVX2: return slabAVX2(rays, bmin, bmax, tMax, tEntry);
+#ifdef __SSE2__
+        case SIMD_SSE: return slabSSE(rays, bmin, bmax, tMax, tEntry);
+#endif
+#endif
+        default: return slabScalar(rays, bmin, bmax, tMax, tEntry);
+    }
+}
+
+} // namespace PhysicsKernels
@@ -0,0 +1,155 @@
+#include "Physics/PhysicsEngine.h"
+#include "Physics/PhysicsKernels.h"
+#include <cmath>
+
+namespace {
+
+const size_t RAY_CHUNK = 64; // Rays per parallelFor chunk in raycastBatch
+
+// Unit direction and its slab-test inverse; false for a zero direction
+bool prepareRay(const Vector3& direction, float dir[3], float inv[3]) {
+    float len = direction.length();
+    if (!(len > 0.0f)) return false;
+    dir[0] = direction.x / len;
+    dir[1] = direction.y / len;
+    dir[2] = direction.z / len;
+    for (int a = 0; a < 3; a++) inv[a] = PhysicsKernels::inverseDirection(dir[a]);
+    return true;
+}
+
+} // namespace
+
+void PhysicsEngine::refreshQueryTree() {
+    if (queryTreeState == QUERY_TREE_STALE || (queryTreeState == QUERY_TREE_MOVED && !queryTree.refit(bodies))) {
+        queryTree.build(bodies);
+    }
+    queryTreeState = QUERY_TREE_CURRENT;
+}
+
+void PhysicsEngine::fillHit(int body, const float origin[3], const float dir[3], const float expand[3], float t,
+                            RaycastHit& hit) const {
+    uint32_t slot = bodies.slots[body];
+    hit.body = PhysicsHandle(slot, slots[slot].generation);
+    hit.distance = t;
+    hit.point = Vector3(origin[0] + dir[0] * t, origin[1] + dir[1] * t, origin[2] + dir[2] * t);
+
+    // The face entered last is the one hit; none if the query began inside
+    const float pos[3] = { bodies.posX[body], bodies.posY[body], bodies.posZ[body] };
+    const float size[3] = { bodies.sizeX[body], bodies.sizeY[body], bodies.sizeZ[body] };
+    int axis = -1;
+    float latest = 0.0f;
+    for (int a = 0; a < 3; a++) {
+        if (dir[a] == 0.0f) continue;
+        float face = (dir[a] > 0.0f) ? pos[a] - size[a] - expand[a] : pos[a] + size[a] + expand[a];
+        float enter = (face - origin[a]) / dir[a];
+        if (enter >= latest) {
+            latest = enter;
+            axis = a;
+        }
+    }
+    float n[3] = { 0.0f, 0.0f, 0.0f };
+    if (axis >= 0) n[axis] = (dir[axis] > 0.0f) ? -1.0f : 1.0f;
+    hit.normal = Vector3(n[0], n[1], n[2]);
+}
+
+bool PhysicsEngine::raycast(const Vector3& origin, const Vector3& direction, float maxDistance, RaycastHit& hit,
+                            uint32_t layerMask) {
+    // A ray is a sweep of an empty box
+    return sweepAABB(origin, Vector3(), direction, maxDistance, hit, layerMask);
+}
+
+bool PhysicsEngine::sweepAABB(const Vector3& center, const Vector3& halfExtents, const Vector3& direction,
+                              float maxDistance, RaycastHit& hit, uint32_t layerMask) {
+    hit = RaycastHit();
+    float dir[3], inv[3];
+    if (!prepareRay(direction, dir, inv)) return false;
+    refreshQueryTree();
+
+    // A box sweep is a ray against every box grown by the swept half-extents
+    const float origin[3] = { center.x, center.y, center.z };
+    const float expand[3] = { halfExtents.x, halfExtents.y, halfExtents.z };
+    float t;
+    int body = queryTree.raycast(bodies, origin, inv, expand, maxDistance, layerMask, t);
+    if (body < 0) return false;
+    fillHit(body, origin, dir, expand, t, hit);
+    return true;
+}
+
+void PhysicsEngine::raycastBatch(const PhysicsRay* rays, size_t count, RaycastHit* hits, uint32_t layerMask) {
+    refreshQueryTree();
+    const float noExpand[3] = { 0.0f, 0.0f, 0.0f };
+
+    if (raycastMode == RAYCAST_SINGLE) {
+        workerPool.parallelFor(count, RAY_CHUNK, [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                hits[k] = RaycastHit();
+                float dir[3], inv[3];
+                if (!prepareRay(rays[k].direction, dir, inv)) continue;
+                const float origin[3] = { rays[k].origin.x, rays[k].origin.y, rays[k].origin.z };
+                float t;
+                int body = queryTree.raycast(bodies, origin, inv, noExpand, rays[k].maxDistance, layerMask, t);
+                if (body >= 0) fillHit(body, origin, dir, noExpand, t, hits[k]);
+            }
+        });
+        return;
+    }
+
+    // Consecutive rays form a packet; callers get the most out of this by
+    // passing neighbouring rays (a screen tile, a fan) next to each other
+    const size_t packetSize = PhysicsKernels::RAY_PACKET_SIZE;
+    const size_t packets = (count + packetSize - 1) / packetSize;
+    workerPool.parallelFor(packets, RAY_CHUNK / packetSize, [&](size_t begin, size_t end) {
+        for (size_t p = begin; p < end; ++p) {
+            PhysicsKernels::RayPacket packet;
+            float dir[PhysicsKernels::RAY_PACKET_SIZE][3];
+            float tBest[PhysicsKernels::RAY_PACKET_SIZE];
+            int hitId[PhysicsKernels::RAY_PACKET_SIZE];
+            uint32_t active = 0;
+
+            for (size_t lane = 0; lane < packetSize; ++lane) {
+                size_t k = p * packetSize + lane;
+                float inv[3] = { 1.0f, 1.0f, 1.0f };
+                Vector3 origin;
+                tBest[lane] = -1.0f;
+                hitId[lane] = -1;
+                if (k < count) {
+                    hits[k] = RaycastHit();
+                    origin = rays[k].origin;
+                    if (prepareRay(rays[k].direction, dir[lane], inv)) {
+                        tBest[lane] = rays[k].maxDistance;
+                        active |= 1u << lane;
+                    }
+                }
+                packet.originX[lane] = origin.x;
+                packet.originY[lane] = origin.y;
+                packet.originZ[lane] = origin.z;
+                packet.invDirX[lane] = inv[0];
+                packet.invDirY[lane] = inv[1];
+                packet.invDirZ[lane] = inv[2];
+            }
+
+            queryTree.raycastPacket(bodies, packet, active, layerMask, tBest, hitId);
+
+            for (size_t lane = 0; lane < packetSize; ++lane) {
+                if (hitId[lane] < 0) continue;
+                size_t k = p * packetSize + lane;
+                const float origin[3] = { rays[k].origin.x, rays[k].origin.y, rays[k].origin.z };
+                fillHit(hitId[lane], origin, dir[lane], noExpand, tBest[lane], hits[k]);
+            }
+        }
+    });
+}
+
+void PhysicsEngine::overlapAABB(const Vector3& min, const Vector3& max, std::vector<PhysicsHandle>& out,
+                                uint32_t layerMask) {
+    out.clear();
+    refreshQueryTree();
+    const float bmin[3] = { min.x, min.y, min.z };
+    const float bmax[3] = { max.x, max.y, max.z };
+    queryScratch.clear();
+    queryTree.overlap(bodies, bmin, bmax, layerMask, queryScratch);
+    for (int body : queryScratch) {
+        uint32_t slot = bodies.slots[body];
+        out.push_back(PhysicsHandle(slot, slots[slot].generation));
+    }
+}
@@ -0,0 +1,313 @@
+#include "Physics/PhysicsRecorder.h"
+#include "Physics/PhysicsEngine.h"
+#include "Physics/ByteStream.h"
+#include <cstdio>
+
+namespace {
+
+const uint32_t RECORDING_MAGIC = 0x43524850; // "PHRC"
+const uint32_t RECORDING_VERSION = 6;
+
+void writeHandle(ByteWriter& w, PhysicsHandle h) {
+    w.value(h.index);
+    w.value(h.generation);
+}
+
+bool readHandle(ByteReader& r, PhysicsHandle& h) {
+    return r.value(h.index) && r.value(h.generation);
+}
+
+void writeVector(ByteWriter& w, const Vector3& v) {
+    w.value(v.x);
+    w.value(v.y);
+    w.value(v.z);
+}
+
+bool readVector(ByteReader& r, Vector3& v) {
+    return r.value(v.x) && r.value(v.y) && r.value(v.z);
+}
+
+} // namespace
+
+PhysicsRecorder::PhysicsRecorder() : target(nullptr), steps(0) {}
+
+PhysicsRecorder::~PhysicsRecorder() {
+    stop();
+}
+
+void PhysicsRecorder::start(PhysicsEngine& engine) {
+    stop();
+    snapshot.clear();
+    events.clear();
+    steps = 0;
+    engine.saveSnapshot(snapshot);
+    engine.setRecorder(this);
+    target = &engine;
+}
+
+void PhysicsRecorder::stop() {
+    if (target) target->setRecorder(nullptr);
+    target = nullptr;
+}
+
+// ================================================================
+// Recording
+// ================================================================
+void PhysicsRecorder::recordStep(float dt) {
+    ByteWriter w(events);
+    w.value((uint8_t)EVENT_STEP);
+    w.value(dt);
+    steps++;
+}
+
+void PhysicsRecorder::recordAdd(const PhysicsObject& desc) {
+    ByteWriter w(events);
+    w.value((uint8_t)EVENT_ADD);
+    writeVector(w, desc.position);
+    writeVector(w, desc.velocity);
+    writeVector(w, desc.acceleration);
+    w.value(desc.mass);
+    w.value(desc.friction);
+    w.value(desc.restitution);
+    w.value((uint8_t)desc.isStatic);
+    writeVector(w, desc.size);
+    w.value((uint8_t)desc.shape);
+    w.value(desc.collisionCategory);
+    w.value(desc.collisionMask);
+}
+
+void PhysicsRecorder::recordRemove(const PhysicsHandle* handles, size_t count) {
+    ByteWriter w(events);
+    if (count == 1) {
+        w.value((uint8_t)EVENT_REMOVE);
+    } else {
+        w.value((uint8_t)EVENT_REMOVE_MANY);
+        w.value((uint32_t)count);
+    }
+    for (size_t i = 0; i < count; i++) writeHandle(w, handles[i]);
+}
+
+void PhysicsRecorder::recordClear() {
+    ByteWriter w(events);
+    w.value((uint8_t)EVENT_CLEAR);
+}
+
+void PhysicsRecorder::recordVector(Event event, PhysicsHandle handle, const Vector3& v) {
+    ByteWriter w(events);
+    w.value((uint8_t)event);
+    writeHandle(w, handle);
+    writeVector(w, v);
+}
+
+void PhysicsRecorder::recordScalar(Event event, PhysicsHandle handle, float value) {
+    ByteWriter w(events);
+    w.value((uint8_t)event);
+    writeHandle(w, handle);
+    w.value(value);
+}
+
+void PhysicsRecorder::recordSetting(Event event, float a, float b) {
+    ByteWriter w(events);
+    w.value((uint8_t)event);
+    w.value(a);
+    w.value(b);
+}
+
+void PhysicsRecorder::recordFilter(PhysicsHandle handle, uint32_t category, uint32_t mask) {
+    ByteWriter w(events);
+    w.value((uint8_t)EVENT_SET_FILTER);
+    writeHandle(w, handle);
+    w.value(category);
+    w.value(mask);
+}
+
+void PhysicsRecorder::recordFocus(const Vector3* points, size_t count) {
+    ByteWriter w(events);
+    w.value((uint8_t)EVENT_LOD_FOCUS);
+    w.value((uint32_t)count);
+    for (size_t i = 0; i < count; i++) writeVector(w, points[i]);
+}
+
+// ================================================================
+// Replay
+// ================================================================
+bool PhysicsRecorder::replay(PhysicsEngine& engine, const std::function<void(float dt)>& step) const {
+    if (!engine.restoreSnapshot(snapshot.data(), snapshot.size())) return false;
+
+    ByteReader r(events.data(), events.size());
+    std::vector<PhysicsHandle> handles;
+    std::vector<Vector3> points;
+    while (r.ok() && !r.atEnd()) {
+        uint8_t event;
+        r.value(event);
+
+        PhysicsHandle h;
+        Vector3 v;
+        float a = 0.0f, b = 0.0f;
+        switch (event) {
+            case EVENT_STEP:
+                if (!r.value(a)) break;
+                if (step) step(a);
+                else engine.update(a);
+                break;
+            case EVENT_ADD: {
+                PhysicsObject desc;
+                uint8_t isStatic = 0, shape = 0;
+                readVector(r, desc.position);
+                readVector(r, desc.velocity);
+                readVector(r, desc.acceleration);
+                r.value(desc.mass);
+                r.value(desc.friction);
+                r.value(desc.restitution);
+                r.value(isStatic);
+                readVector(r, desc.size);
+                r.value(shape);
+                r.value(desc.collisionCategory);
+                r.value(desc.collisionMask);
+                desc.isStatic = isStatic != 0;
+                desc.shape = (CollisionShape)shape;
+                if (r.ok()) engine.addObject(desc);
+                break;
+            }
+            case EVENT_REMOVE:
+                if (readHandle(r, h)) engine.removeObject(h);
+                break;
+            case EVENT_REMOVE_MANY: {
+                uint32_t count = 0;
+                if (!r.value(count) || count > events.size()) {
+                    r.failed = true;
+                    break;
+                }
+                handles.resize(count);
+                for (uint32_t i = 0; i < count; i++) readHandle(r, handles[i]);
+                if (r.ok()) engine.removeObjects(handles);
+                break;
+            }
+            case EVENT_CLEAR:
+                engine.clear();
+                break;
+            case EVENT_SET_POSITION:
+            case EVENT_SET_VELOCITY:
+            case EVENT_SET_ACCELERATION:
+            case EVENT_SET_SIZE:
+                if (!readHandle(r, h) || !readVector(r, v)) break;
+                if (event == EVENT_SET_POSITION) engine.setPosition(h, v);
+                else if (event == EVENT_SET_VELOCITY) engine.setVelocity(h, v);
+                else if (event == EVENT_SET_ACCELERATION) engine.setAcceleration(h, v);
+                else engine.setSize(h, v);
+                break;
+            case EVENT_SET_MASS:
+            case EVENT_SET_FRICTION:
+            case EVENT_SET_RESTITUTION:
+            case EVENT_SET_STATIC:
+            case EVENT_SET_SHAPE:
+            case EVENT_WAKE:
+                if (!readHandle(r, h) || !r.value(a)) break;
+                if (event == EVENT_SET_MASS) engine.setMass(h, a);
+                else if (event == EVENT_SET_FRICTION) engine.setFriction(h, a);
+                else if (event == EVENT_SET_RESTITUTION) engine.setRestitution(h, a);
+                else if (event == EVENT_SET_STATIC) engine.setStatic(h, a != 0.0f);
+                else if (event == EVENT_SET_SHAPE) engine.setShape(h, (CollisionShape)(int)a);
+                else engine.wakeObject(h);
+                break;
+            case EVENT_SET_FILTER: {
+                uint32_t category = 0, mask = 0;
+                if (!readHandle(r, h) || !r.value(category) || !r.value(mask)) break;
+                engine.setCollisionFilter(h, category, mask);
+                break;
+            }
+            case EVENT_LOD_FOCUS: {
+                uint32_t count = 0;
+                if (!r.value(count) || count > events.size()) {
+                    r.failed = true;
+                    break;
+                }
+                points.resize(count);
+                for (uint32_t i = 0; i < count; i++) readVector(r, points[i]);
+                if (r.ok()) engine.setLodFocus(points);
+                break;
+            }
+            case EVENT_SLEEP_ENABLED:
+            case EVENT_SLEEP_THRESHOLD:
+            case EVENT_CCD_ENABLED:
+            case EVENT_CCD_THRESHOLD:
+            case EVENT_SOLVER_ITERATIONS:
+            case EVENT_SOLVER_TOLERANCE:
+            case EVENT_LOD_ENABLED:
+            case EVENT_LOD_DISTANCES:
+            case EVENT_LOD_HYSTERESIS:
+            case EVENT_SORT_ENABLED:
+            case EVENT_SORT_POLICY:
+            case EVENT_SORT_NOW:
+                if (!r.value(a) || !r.value(b)) break;
+                if (event == EVENT_SLEEP_ENABLED) engine.setSleepEnabled(a != 0.0f);
+                else if (event == EVENT_SLEEP_THRESHOLD) engine.setSleepThreshold(a, b);
+                else if (event == EVENT_CCD_ENABLED) engine.setCcdEnabled(a != 0.0f);
+                else if (event == EVENT_CCD_THRESHOLD) engine.setCcdThreshold(a);
+                else if (event == EVENT_SOLVER_ITERATIONS) engine.setSolverIterations((int)a);
+                else if (event == EVENT_SOLVER_TOLERANCE) engine.setSolverTolerance(a);
+                else if (event == EVENT_LOD_ENABLED) engine.setLodEnabled(a != 0.0f);
+                else if (event == EVENT_LOD_DISTANCES) engine.setLodDistances(a, b);
+                else if (event == EVENT_LOD_HYSTERESIS) engine.setLodHysteresis(a);
+                else if (event == EVENT_SORT_ENABLED) engine.setSpatialSortEnabled(a != 0.0f);
+                else if (event == EVENT_SORT_POLICY) engine.setSpatialSortPolicy((int)a, b);
+                else engine.sortBodies();
+                break;
+            default:
+                r.failed = true;
+                break;
+        }
+    }
+    return r.ok();
+}
+
+// ================================================================
+// Files: header, snapshot, event stream
+// ================================================================
+bool PhysicsRecorder::save(const char* path) const {
+    std::vector<uint8_t> header;
+    ByteWriter w(header);
+    w.value(RECORDING_MAGIC);
+    w.value(RECORDING_VERSION);
+    w.value((uint32_t)steps);
+    w.value((uint64_t)snapshot.size());
+    w.value((uint64_t)events.size());
+
+    FILE* f = std::fopen(path, "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(header.data(), 1, header.size(), f) == header.size() &&
+              std::fwrite(snapshot.data(), 1, snapshot.size(), f) == snapshot.size() &&
+              std::fwrite(events.data(), 1, events.size(), f) == events.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+bool PhysicsRecorder::load(const char* path) {
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+    std::vector<uint8_t> file;
+    uint8_t buffer[65536];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), f)) > 0) {
+        file.insert(file.end(), buffer, buffer + n);
+    }
+    std::fclose(f);
+
+    ByteReader r(file.data(), file.size());
+    uint32_t magic = 0, version = 0, stepCount = 0;
+    uint64_t snapshotSize = 0, eventsSize = 0;
+    r.value(magic);
+    r.value(version);
+    r.value(stepCount);
+    r.value(snapshotSize);
+    r.value(eventsSize);
+    if (!r.ok() || magic != RECORDING_MAGIC || version != RECORDING_VERSION) return false;
+    if (snapshotSize > file.size() - r.pos || eventsSize != file.size() - r.pos - snapshotSize) return false;
+
+    stop();
+    snapshot.resize(snapshotSize);
+    events.resize(eventsSize);
+    r.array(snapshot);
+    r.array(events);
+    steps = (int)stepCount;
+    return r.ok();
+}
@@ -0,0 +1,164 @@
+#include "Physics/PhysicsEngine.h"
+#include "Physics/ByteStream.h"
+#include <algorithm>
+
+namespace {
+
+const uint32_t SNAPSHOT_MAGIC = 0x4E534850; // "PHSN"
+const uint32_t SNAPSHOT_VERSION = 6;
+
+} // namespace
+
+// Layout: header, settings, then each body column in forEachColumn
+// order, the handle slot table, the free slot list, the solver's
+// warm-start impulses and the LOD focus points, all raw.
+void PhysicsEngine::saveSnapshot(std::vector<uint8_t>& out) const {
+    ByteWriter w(out);
+    w.value(SNAPSHOT_MAGIC);
+    w.value(SNAPSHOT_VERSION);
+    w.value((uint32_t)bodies.size());
+    w.value((uint32_t)slots.size());
+    w.value((uint32_t)freeSlots.size());
+    w.value((uint32_t)impulseCache.size());
+    w.value((uint32_t)lodFocus.size());
+
+    w.value((uint8_t)sleepEnabled);
+    w.value(sleepVelocity);
+    w.value(sleepTime);
+    w.value((uint8_t)ccdEnabled);
+    w.value(ccdThreshold);
+    w.value((int32_t)solverIterations);
+    w.value(solverTolerance);
+    w.value((uint8_t)lodEnabled);
+    w.value(lodNear);
+    w.value(lodFar);
+    w.value(lodHysteresis);
+    w.value(lodStep);
+    w.value((uint8_t)spatialSortEnabled);
+    w.value((int32_t)spatialSortInterval);
+    w.value(spatialSortThreshold);
+    w.value(spatialSortStep);
+
+    bodies.forEachColumn([&w](const auto& col) { w.array(col); });
+    w.array(slots);
+    w.array(freeSlots);
+    w.array(impulseCache);
+    w.array(lodFocus);
+}
+
+uint64_t PhysicsEngine::stateHash(uint64_t hash) const {
+    std::vector<uint8_t> snapshot;
+    saveSnapshot(snapshot);
+    for (uint8_t byte : snapshot) hash = (hash ^ byte) * 1099511628211ull;
+    return hash;
+}
+
+bool PhysicsEngine::restoreSnapshot(const uint8_t* data, size_t size) {
+    ByteReader r(data, size);
+    uint32_t magic = 0, version = 0, bodyCount = 0, slotCount = 0, freeCount = 0, cacheCount = 0, focusCount = 0;
+    uint32_t lodSteps = 0, sortSteps = 0;
+    int32_t iterations = 0, sortInterval = 0;
+    uint8_t sleepOn = 0, ccdOn = 0, lodOn = 0, sortOn = 0;
+    float sleepVel = 0.0f, sleepSecs = 0.0f, ccdFraction = 0.0f, tolerance = 0.0f;
+    float nearDistance = 0.0f, farDistance = 0.0f, margin = 0.0f, sortThreshold = 0.0f;
+    r.value(magic);
+    r.value(version);
+    r.value(bodyCount);
+    r.value(slotCount);
+    r.value(freeCount);
+    r.value(cacheCount);
+    r.value(focusCount);
+    r.value(sleepOn);
+    r.value(sleepVel);
+    r.value(sleepSecs);
+    r.value(ccdOn);
+    r.value(ccdFraction);
+    r.value(iterations);
+    r.value(tolerance);
+    r.value(lodOn);
+    r.value(nearDistance);
+    r.value(farDistance);
+    r.value(margin);
+    r.value(lodSteps);
+    r.value(sortOn);
+    r.value(sortInterval);
+    r.value(sortThreshold);
+    r.value(sortSteps);
+    if (!r.ok() || magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) return false;
+
+    // Check the payload size before touching any state
+    size_t bytesPerBody = 0;
+    bodies.forEachColumn([&bytesPerBody](const auto& col) { bytesPerBody += sizeof(col[0]); });
+    size_t expected = (size_t)bodyCount * bytesPerBody + (size_t)slotCount * sizeof(Slot) +
+                      (size_t)freeCount * sizeof(uint32_t) + (size_t)cacheCount * sizeof(CachedImpulse) +
+                      (size_t)focusCount * sizeof(Vector3);
+    if (size - r.pos != expected) return false;
+
+    // The handle table indexes everything else, so it is read aside and
+    // checked before any state is replaced
+    restoreBodies.resize(bodyCount);
+    restoreSlots.resize(slotCount);
+    restoreFreeSlots.resize(freeCount);
+    restoreBodies.forEachColumn([&r](auto& col) { r.array(col); });
+    r.array(restoreSlots);
+    r.array(restoreFreeSlots);
+    if (!r.ok() || !restoredHandlesValid()) return false;
+
+    std::swap(bodies, restoreBodies);
+    slots.swap(restoreSlots);
+    freeSlots.swap(restoreFreeSlots);
+    impulseCache.resize(cacheCount);
+    lodFocus.resize(focusCount);
+    r.array(impulseCache);
+    r.array(lodFocus);
+
+    sleepEnabled = sleepOn != 0;
+    sleepVelocity = sleepVel;
+    sleepTime = sleepSecs;
+    ccdEnabled = ccdOn != 0;
+    ccdThreshold = ccdFraction;
+    solverIterations = std::max(1, (int)iterations);
+    solverTolerance = tolerance;
+    lodEnabled = lodOn != 0;
+    lodNear = nearDistance;
+    lodFar = farDistance;
+    lodHysteresis = margin;
+    lodStep = lodSteps;
+    spatialSortEnabled = sortOn != 0;
+    spatialSortInterval = std::max(1, (int)sortInterval);
+    spatialSortThreshold = sortThreshold;
+    spatialSortStep = sortSteps;
+    stats = PhysicsStats();
+    markQueryTree(QUERY_TREE_STALE);
+
+    // Contacts start over: the first step reports everything as BEGIN
+    contactsPrevious.clear();
+    contactEvents.clear();
+    return r.ok();
+}
+
+// Every body and every live slot must point at each other, one to one,
+// and the free list must hold distinct dead slots
+bool PhysicsEngine::restoredHandlesValid() {
+    const size_t bodyCount = restoreBodies.size();
+    const size_t slotCount = restoreSlots.size();
+
+    for (size_t i = 0; i < bodyCount; ++i) {
+        uint32_t slot = restoreBodies.slots[i];
+        if (slot >= slotCount || restoreSlots[slot].dense != i) return false;
+    }
+    for (size_t s = 0; s < slotCount; ++s) {
+        uint32_t dense = restoreSlots[s].dense;
+        if (dense == PhysicsHandle::INVALID_INDEX) continue;
+        if (dense >= bodyCount || restoreBodies.slots[dense] != s) return false;
+    }
+
+    restoreSeen.assign(slotCount, 0);
+    for (uint32_t slot : restoreFreeSlots) {
+        if (slot >= slotCount || restoreSlots[slot].dense != PhysicsHandle::INVALID_INDEX || restoreSeen[slot]) {
+            return false;
+        }
+        restoreSeen[slot] = 1;
+    }
+    return true;
+}
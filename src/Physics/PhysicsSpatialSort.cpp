@@ -0,0 +1,111 @@
+#include "Physics/PhysicsEngine.h"
+#include "Physics/PhysicsRecorder.h"
+#include <algorithm>
+
+namespace {
+
+const uint32_t MORTON_MAX = 1023; // 10 bits per axis, a 30-bit code
+const uint32_t COARSE_SHIFT = 12; // Disorder is measured on 6 bits per axis, so jitter does not count
+
+// Spreads the low 10 bits of v to every third bit
+uint32_t spreadBits(uint32_t v) {
+    v = (v | (v << 16)) & 0x030000FFu;
+    v = (v | (v << 8)) & 0x0300F00Fu;
+    v = (v | (v << 4)) & 0x030C30C3u;
+    v = (v | (v << 2)) & 0x09249249u;
+    return v;
+}
+
+// Position on [lo, lo + MORTON_MAX / scale] to a grid coordinate; NaN maps to 0
+uint32_t quantize(float p, float lo, float scale) {
+    float t = (p - lo) * scale;
+    if (!(t > 0.0f)) return 0;
+    return t < (float)MORTON_MAX ? (uint32_t)t : MORTON_MAX;
+}
+
+} // namespace
+
+void PhysicsEngine::setSpatialSortEnabled(bool enabled) {
+    if (recorder) recorder->recordSetting(PhysicsRecorder::EVENT_SORT_ENABLED, enabled ? 1.0f : 0.0f);
+    spatialSortEnabled = enabled;
+}
+
+void PhysicsEngine::setSpatialSortPolicy(int interval, float threshold) {
+    if (recorder) recorder->recordSetting(PhysicsRecorder::EVENT_SORT_POLICY, (float)interval, threshold);
+    spatialSortInterval = std::max(1, interval);
+    spatialSortThreshold = std::max(threshold, 0.0f);
+}
+
+void PhysicsEngine::sortBodies() {
+    if (recorder) recorder->recordSetting(PhysicsRecorder::EVENT_SORT_NOW, 0.0f);
+    computeSortKeys();
+    applySortOrder();
+}
+
+// Morton code of every body over the bounds of all positions, paired with
+// its dense index. Returns the fraction of neighbouring bodies whose codes
+// are out of order: 0 right after a sort, about half for a shuffle.
+float PhysicsEngine::computeSortKeys() {
+    const size_t count = bodies.size();
+    sortKeys.resize(count);
+    if (count < 2) return 0.0f;
+
+    // One scale on every axis, so the cells are cubes: a flat scene does
+    // not get thin cells on Y that every small bounce crosses
+    const float* pos[3] = { bodies.posX.data(), bodies.posY.data(), bodies.posZ.data() };
+    float lo[3];
+    float extent = 0.0f;
+    for (int a = 0; a < 3; a++) {
+        float hi = pos[a][0];
+        lo[a] = hi;
+        for (size_t i = 1; i < count; ++i) {
+            lo[a] = std::min(lo[a], pos[a][i]);
+            hi = std::max(hi, pos[a][i]);
+        }
+        extent = std::max(extent, hi - lo[a]);
+    }
+    const float scale = (extent > 0.0f) ? (float)MORTON_MAX / extent : 0.0f;
+
+    size_t descents = 0;
+    uint32_t previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t code = spreadBits(quantize(pos[0][i], lo[0], scale)) |
+                        (spreadBits(quantize(pos[1][i], lo[1], scale)) << 1) |
+                        (spreadBits(quantize(pos[2][i], lo[2], scale)) << 2);
+        uint32_t coarse = code >> COARSE_SHIFT;
+        if (i > 0 && coarse < previous) descents++;
+        previous = coarse;
+        sortKeys[i] = ((uint64_t)code << 32) | i;
+    }
+    return (float)descents / (float)(count - 1);
+}
+
+// Moves every body to its rank in sortKeys and repoints the handle table.
+// Everything else indexed by body is either rebuilt each step or keyed by
+// handle, so only the query tree needs a rebuild.
+void PhysicsEngine::applySortOrder() {
+    const size_t count = bodies.size();
+    if (count < 2) return;
+
+    // Ties keep their current order through the index in the low bits
+    std::sort(sortKeys.begin(), sortKeys.end());
+    sortOrder.resize(count);
+    for (size_t i = 0; i < count; ++i) sortOrder[i] = (uint32_t)sortKeys[i];
+
+    bodies.permuteInto(sortedBodies, sortOrder);
+    std::swap(bodies, sortedBodies);
+    for (size_t i = 0; i < count; ++i) slots[bodies.slots[i]].dense = (uint32_t)i;
+    markQueryTree(QUERY_TREE_STALE);
+}
+
+void PhysicsEngine::maintainSpatialSort() {
+    stats.spatialSorts = 0;
+    if (!spatialSortEnabled || (int)++spatialSortStep < spatialSortInterval) return;
+    spatialSortStep = 0;
+
+    stats.disorder = computeSortKeys();
+    if (stats.disorder > spatialSortThreshold) {
+        applySortOrder();
+        stats.spatialSorts = 1;
+    }
+}
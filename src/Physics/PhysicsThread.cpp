@@ -0,0 +1,147 @@
+#include "Physics/PhysicsThread.h"
+#include "Physics/PhysicsEngine.h"
+#include <algorithm>
+#include <cmath>
+
+typedef std::chrono::steady_clock Clock;
+
+bool PhysicsFrame::getPosition(PhysicsHandle handle, float alpha, Vector3& out) const {
+    if (handle.index >= generations.size() || generations[handle.index] != handle.generation) return false;
+    const Vector3& a = previous[handle.index];
+    const Vector3& b = current[handle.index];
+    out = a + (b - a) * alpha;
+    return true;
+}
+
+float PhysicsFrame::alphaAt(Clock::time_point now) const {
+    float alpha = std::chrono::duration<float>(now - time).count() / stepLength;
+    return std::min(std::max(alpha, 0.0f), 1.0f);
+}
+
+PhysicsThread::PhysicsThread(PhysicsEngine& e)
+    : engine(e), running(false), paused(false), stepLength(1.0f / 60.0f), maxSubsteps(5),
+      back(0), front(1), middle(2), lastStep(0), lastStepTime(Clock::now()) {}
+
+PhysicsThread::~PhysicsThread() {
+    stop();
+}
+
+void PhysicsThread::start() {
+    if (thread.joinable()) return;
+    running = true;
+    thread = std::thread(&PhysicsThread::run, this);
+}
+
+void PhysicsThread::stop() {
+    running = false;
+    if (thread.joinable()) thread.join();
+}
+
+void PhysicsThread::setPaused(bool p) {
+    paused = p;
+}
+
+void PhysicsThread::setRate(float hz) {
+    if (hz < 1.0f) hz = 1.0f;
+    stepLength = 1.0f / hz;
+}
+
+void PhysicsThread::setMaxSubsteps(int steps) {
+    maxSubsteps = steps < 1 ? 1 : steps;
+}
+
+void PhysicsThread::enqueue(std::function<void(PhysicsEngine&)> command) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    commands.push_back(std::move(command));
+}
+
+const PhysicsFrame& PhysicsThread::acquireFrame() {
+    // Only swap when the writer has published since our last look
+    if (middle.load(std::memory_order_acquire) & FRESH) {
+        front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+    }
+    return frames[front];
+}
+
+// ================================================================
+// Physics thread
+// ================================================================
+void PhysicsThread::run() {
+    Clock::time_point last = Clock::now();
+    float accumulator = 0.0f;
+
+    while (running) {
+        Clock::time_point now = Clock::now();
+        float elapsed = std::chrono::duration<float>(now - last).count();
+        last = now;
+        float dt = stepLength;
+
+        {
+            std::lock_guard<std::mutex> lock(engineMutex);
+            applyCommands();
+
+            if (paused) {
+                accumulator = 0.0f; // Don't count paused time on resume
+            } else {
+                // Fixed steps for the time that passed, at most maxSubsteps;
+                // the rest is dropped so a slow step cannot snowball
+                accumulator += elapsed;
+                int steps = 0;
+                while (accumulator >= dt && steps < maxSubsteps) {
+                    engine.update(dt);
+                    publish(true);
+                    accumulator -= dt;
+                    steps++;
+                }
+                if (accumulator >= dt) accumulator = std::fmod(accumulator, dt);
+            }
+        }
+
+        // Sleep until the next step is due
+        std::this_thread::sleep_for(std::chrono::duration<float>(std::max(dt - accumulator, 0.0f)));
+    }
+}
+
+void PhysicsThread::applyCommands() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        pending.swap(commands);
+    }
+    if (pending.empty()) return;
+
+    for (auto& command : pending) command(engine);
+    pending.clear();
+    publish(false);
+}
+
+// Fills the back frame and swaps it into the middle. Only called with
+// engineMutex held, so the physics thread and withEngine() never write
+// the back frame at the same time.
+void PhysicsThread::publish(bool stepped) {
+    PhysicsFrame& frame = frames[back];
+
+    engine.copySlotPositions(frame.current, frame.generations);
+    frame.stepLength = stepLength;
+
+    // A step interpolates from where bodies were at the last publish. A
+    // publish without a step (commands, withEngine) keeps the interval
+    // of the last step so rendering does not jump.
+    if (stepped) {
+        stepStart.swap(lastPositions);
+        stepStartGenerations.swap(lastGenerations);
+        lastStep++;
+        lastStepTime = Clock::now();
+    }
+    frame.step = lastStep;
+    frame.time = lastStepTime;
+
+    frame.previous.resize(frame.current.size());
+    for (size_t s = 0; s < frame.current.size(); ++s) {
+        bool known = s < stepStart.size() && stepStartGenerations[s] == frame.generations[s];
+        frame.previous[s] = known ? stepStart[s] : frame.current[s];
+    }
+    lastPositions = frame.current;
+    lastGenerations = frame.generations;
+
+    back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & ~FRESH;
+}
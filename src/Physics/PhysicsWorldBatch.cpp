@@ -0,0 +1,57 @@
+#include "Physics/PhysicsWorldBatch.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+PhysicsWorldBatch::PhysicsWorldBatch(int threadCount)
+    : lastWorldStepsPerSecond(0.0), totalWorldSteps(0) {
+    setThreadCount(threadCount);
+}
+
+PhysicsWorldBatch::~PhysicsWorldBatch() {
+}
+
+PhysicsEngine& PhysicsWorldBatch::addWorld() {
+    // The batch already runs one world per thread; nested pools would
+    // only oversubscribe the cores, so each world gets none from the start
+    worlds.emplace_back(new PhysicsEngine(1));
+    PhysicsEngine& world = *worlds.back();
+    world.sampleTerrainHeights = terrain;
+    return world;
+}
+
+void PhysicsWorldBatch::clear() {
+    worlds.clear();
+}
+
+void PhysicsWorldBatch::setTerrain(HeightSampler sampler) {
+    terrain = sampler;
+    for (auto& world : worlds) world->sampleTerrainHeights = terrain;
+}
+
+void PhysicsWorldBatch::setThreadCount(int count) {
+    if (count <= 0) {
+        unsigned cores = std::thread::hardware_concurrency();
+        count = cores == 0 ? 1 : (int)cores;
+    }
+    pool.setThreadCount(count);
+}
+
+void PhysicsWorldBatch::step(float dt, int steps) {
+    if (worlds.empty() || steps <= 0) return;
+
+    auto t0 = std::chrono::steady_clock::now();
+    // One world per chunk: worlds settle and sleep at different rates, so
+    // small chunks keep the threads evenly loaded
+    pool.parallelFor(worlds.size(), 1, [this, dt, steps](size_t begin, size_t end) {
+        for (size_t w = begin; w < end; w++) {
+            for (int s = 0; s < steps; s++) worlds[w]->update(dt);
+        }
+    });
+    auto t1 = std::chrono::steady_clock::now();
+
+    uint64_t worldSteps = (uint64_t)worlds.size() * (uint64_t)steps;
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+    lastWorldStepsPerSecond = seconds > 0.0 ? worldSteps / seconds : 0.0;
+    totalWorldSteps += worldSteps;
+}
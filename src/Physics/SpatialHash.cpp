@@ -0,0 +1,152 @@
+#include "Physics/SpatialHash.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const float MAX_CELL_SPAN = 64.0f;        // Cells per axis before a body counts as large
+const float MAX_CELL_COORD = 1073741824.0f; // 2^30, well inside int32_t
+const size_t MAX_BUCKETS = size_t(1) << 31; // More than the 32-bit hash can tell apart would not help
+
+} // namespace
+
+SpatialHash::SpatialHash(float size) : bucketMask(0) {
+    setCellSize(size);
+}
+
+void SpatialHash::setCellSize(float size) {
+    if (size < 0.01f) size = 0.01f;
+    cellSize = size;
+    invCellSize = 1.0f / size;
+}
+
+void SpatialHash::clear(int count) {
+    cellMinX.assign(count, 0);
+    cellMinZ.assign(count, 0);
+    cellMaxX.assign(count, -1); // Empty range until inserted
+    cellMaxZ.assign(count, -1);
+    staticIds.assign(count, 0);
+    largeFlags.assign(count, 0);
+    entries.clear();
+}
+
+void SpatialHash::insert(int id, float minX, float minZ, float maxX, float maxZ, bool isStatic) {
+    staticIds[id] = isStatic ? 1 : 0;
+    float x0 = std::floor(minX * invCellSize);
+    float z0 = std::floor(minZ * invCellSize);
+    float x1 = std::floor(maxX * invCellSize);
+    float z1 = std::floor(maxZ * invCellSize);
+
+    // Written so that NaN fails every test: such bodies, and footprints
+    // spanning too many cells or beyond int32_t, stay out of the grid
+    bool fits = x1 - x0 < MAX_CELL_SPAN && z1 - z0 < MAX_CELL_SPAN &&
+                x0 > -MAX_CELL_COORD && z0 > -MAX_CELL_COORD && x1 < MAX_CELL_COORD && z1 < MAX_CELL_COORD;
+    largeFlags[id] = fits ? 0 : 1;
+    if (!fits) {
+        cellMinX[id] = cellMinZ[id] = 0;
+        cellMaxX[id] = cellMaxZ[id] = -1;
+        return;
+    }
+    cellMinX[id] = (int32_t)x0;
+    cellMinZ[id] = (int32_t)z0;
+    cellMaxX[id] = (int32_t)x1;
+    cellMaxZ[id] = (int32_t)z1;
+}
+
+uint32_t SpatialHash::bucketOf(int32_t cx, int32_t cz) const {
+    uint32_t h = ((uint32_t)cx * 73856093u) ^ ((uint32_t)cz * 19349663u);
+    return h & bucketMask;
+}
+
+void SpatialHash::build() {
+    int count = (int)cellMinX.size();
+
+    largeIds.clear();
+    size_t total = 0;
+    for (int i = 0; i < count; i++) {
+        if (largeFlags[i]) largeIds.push_back(i);
+        if (cellMaxX[i] < cellMinX[i]) continue;
+        total += (size_t)(cellMaxX[i] - cellMinX[i] + 1) * (cellMaxZ[i] - cellMinZ[i] + 1);
+    }
+
+    // Keep the load factor at or below 0.5 so buckets stay short
+    size_t buckets = 64;
+    while (buckets < total * 2 && buckets < MAX_BUCKETS) buckets <<= 1;
+    bucketMask = (uint32_t)(buckets - 1);
+
+    // Counting sort of (cell, body) entries into buckets
+    bucketStart.assign(buckets + 1, 0);
+    for (int i = 0; i < count; i++) {
+        for (int32_t cz = cellMinZ[i]; cz <= cellMaxZ[i]; cz++) {
+            for (int32_t cx = cellMinX[i]; cx <= cellMaxX[i]; cx++) {
+                bucketStart[bucketOf(cx, cz) + 1]++;
+            }
+        }
+    }
+    for (size_t b = 0; b < buckets; b++) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    entries.resize(total);
+    cursor.assign(bucketStart.begin(), bucketStart.end() - 1);
+    for (int i = 0; i < count; i++) {
+        for (int32_t cz = cellMinZ[i]; cz <= cellMaxZ[i]; cz++) {
+            for (int32_t cx = cellMinX[i]; cx <= cellMaxX[i]; cx++) {
+                Entry& e = entries[cursor[bucketOf(cx, cz)]++];
+                e.cx = cx;
+                e.cz = cz;
+                e.id = i;
+                e.isStatic = staticIds[i];
+            }
+        }
+    }
+}
+
+void SpatialHash::queryCandidates(int id, std::vector<int>& out) const {
+    query(id, true, out);
+}
+
+void SpatialHash::queryNeighbours(int id, std::vector<int>& out) const {
+    query(id, false, out);
+}
+
+void SpatialHash::query(int id, bool higherOnly, std::vector<int>& out) const {
+    size_t first = out.size();
+    uint32_t skipStatic = staticIds[id];
+
+    // A large body is tested against everyone, like the brute-force path
+    if (largeFlags[id]) {
+        int count = (int)staticIds.size();
+        for (int j = higherOnly ? id + 1 : 0; j < count; j++) {
+            if (j != id && !(staticIds[j] & skipStatic)) out.push_back(j);
+        }
+        return;
+    }
+
+    for (int32_t cz = cellMinZ[id]; cz <= cellMaxZ[id]; cz++) {
+        for (int32_t cx = cellMinX[id]; cx <= cellMaxX[id]; cx++) {
+            uint32_t b = bucketOf(cx, cz);
+            for (uint32_t k = bucketStart[b]; k < bucketStart[b + 1]; k++) {
+                const Entry& e = entries[k];
+                if (e.id == id || (higherOnly && e.id < id) || e.cx != cx || e.cz != cz) continue;
+                if (e.isStatic & skipStatic) continue;
+
+                // Only report from the lowest cell both bodies share
+                int32_t ownerX = std::max(cellMinX[id], cellMinX[e.id]);
+                int32_t ownerZ = std::max(cellMinZ[id], cellMinZ[e.id]);
+                if (cx != ownerX || cz != ownerZ) continue;
+
+                out.push_back(e.id);
+            }
+        }
+    }
+
+    // Large bodies share a "cell" with everyone
+    for (int j : largeIds) {
+        if ((higherOnly && j < id) || (staticIds[j] & skipStatic)) continue;
+        out.push_back(j);
+    }
+
+    // Match the brute-force visiting order
+    std::sort(out.begin() + first, out.end());
+}
@@ -0,0 +1,95 @@
+#include "Physics/WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(int threadCount)
+    : stopping(false), jobId(0), job(nullptr), jobCount(0), jobChunkSize(1), jobChunks(0),
+      nextChunk(0), busyWorkers(0) {
+    setThreadCount(threadCount);
+}
+
+WorkerPool::~WorkerPool() {
+    stopWorkers();
+}
+
+void WorkerPool::setThreadCount(int count) {
+    if (count < 1) count = 1;
+    if (count == getThreadCount()) return;
+    stopWorkers();
+    startWorkers(count - 1);
+}
+
+void WorkerPool::startWorkers(int count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = false;
+    // Workers start from the current job id; reading it inside the thread
+    // could miss a job published before the thread got scheduled
+    for (int i = 0; i < count; i++) {
+        workers.emplace_back(&WorkerPool::workerLoop, this, jobId);
+    }
+}
+
+void WorkerPool::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCv.notify_all();
+    for (auto& t : workers) t.join();
+    workers.clear();
+}
+
+void WorkerPool::workerLoop(uint64_t seenJob) {
+    for (;;) {
+        std::unique_lock<std::mutex> lock(mutex);
+        wakeCv.wait(lock, [&] { return stopping || jobId != seenJob; });
+        if (stopping) return;
+        seenJob = jobId;
+        lock.unlock();
+
+        runChunks();
+
+        lock.lock();
+        if (--busyWorkers == 0) doneCv.notify_one();
+    }
+}
+
+void WorkerPool::runChunks() {
+    size_t chunk;
+    while ((chunk = nextChunk.fetch_add(1)) < jobChunks) {
+        size_t begin = chunk * jobChunkSize;
+        size_t end = std::min(jobCount, begin + jobChunkSize);
+        (*job)(begin, end);
+    }
+}
+
+void WorkerPool::parallelFor(size_t count, size_t chunkSize, const RangeFn& fn) {
+    if (count == 0) return;
+    if (chunkSize == 0) chunkSize = 1;
+    size_t chunks = (count + chunkSize - 1) / chunkSize;
+
+    // Not worth waking anyone up
+    if (workers.empty() || chunks == 1) {
+        for (size_t begin = 0; begin < count; begin += chunkSize) {
+            fn(begin, std::min(count, begin + chunkSize));
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobCount = count;
+        jobChunkSize = chunkSize;
+        jobChunks = chunks;
+        nextChunk.store(0);
+        busyWorkers = (int)workers.size();
+        jobId++;
+    }
+    wakeCv.notify_all();
+
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCv.wait(lock, [&] { return busyWorkers == 0; });
+    job = nullptr;
+}
@@ -1,4 +1,6 @@
 #include "Scene.h"
+#include "ShapeMeshes.h"
+#include <algorithm>
 #include <cstdlib>
 #include <cmath>
 #include <iostream>
@@ -10,8 +12,14 @@
 // Shape Implementations
 // ==========================================
 
+// Shapes draw from the cached meshes in ShapeMeshes; SHAPE_IMMEDIATE_MODE
+// keeps the original glBegin/glEnd paths for comparison
+
 // --- Cube ---
 void Cube::draw() const {
+#ifndef SHAPE_IMMEDIATE_MODE
+    ShapeMeshes::draw(ShapeMeshes::MESH_CUBE, 0, position, size, color);
+#else
     glPushMatrix();
     glTranslatef(position.x, position.y, position.z);
     glColor3f(color.x, color.y, color.z);
@@ -37,6 +45,7 @@ void Cube::draw() const {
         glVertex3f(-s, -s, -s); glVertex3f(-s, -s,  s); glVertex3f(-s,  s,  s); glVertex3f(-s,  s, -s);
     glEnd();
     glPopMatrix();
+#endif
 }
 
 void Cube::drawWireframe() const {
@@ -63,20 +72,11 @@ void Cube::drawWireframe() const {
     glPopMatrix();
 }
 
-float Cube::intersect(const float origin[3], const float dir[3]) const {
-    float t = -1.0f;
-    float s = size;
-    // Utilize the existing AABB test
-    if (rayIntersectsAABB(origin, dir, 
-                                  position.x - s, position.y - s, position.z - s,
-                                  position.x + s, position.y + s, position.z + s, t)) {
-        return t;
-    }
-    return -1.0f;
-}
-
 // --- Sphere ---
 void Sphere::draw() const {
+#ifndef SHAPE_IMMEDIATE_MODE
+    ShapeMeshes::draw(ShapeMeshes::MESH_SPHERE, ShapeMeshes::SPHERE_SEGMENTS, position, size, color);
+#else
     glPushMatrix();
     glTranslatef(position.x, position.y, position.z);
     glColor3f(color.x, color.y, color.z);
@@ -133,6 +133,7 @@ void Sphere::draw() const {
         glEnd();
     }
     glPopMatrix();
+#endif
 }
 
 void Sphere::drawWireframe() const {
@@ -167,19 +168,11 @@ void Sphere::drawWireframe() const {
     glPopMatrix();
 }
 
-float Sphere::intersect(const float origin[3], const float dir[3]) const {
-    // AABB approximation for now
-    float t = -1.0f;
-    if (rayIntersectsAABB(origin, dir, 
-                                  position.x - size, position.y - size, position.z - size,
-                                  position.x + size, position.y + size, position.z + size, t)) {
-        return t;
-    }
-    return -1.0f;
-}
-
 // --- Cylinder ---
 void Cylinder::draw() const {
+#ifndef SHAPE_IMMEDIATE_MODE
+    ShapeMeshes::draw(ShapeMeshes::MESH_CYLINDER, ShapeMeshes::CYLINDER_SEGMENTS, position, size, color);
+#else
     glPushMatrix();
     glTranslatef(position.x, position.y, position.z);
     glColor3f(color.x, color.y, color.z);
@@ -222,6 +215,7 @@ void Cylinder::draw() const {
     glEnd();
     
     glPopMatrix();
+#endif
 }
 
 void Cylinder::drawWireframe() const {
@@ -255,20 +249,11 @@ void Cylinder::drawWireframe() const {
     glPopMatrix();
 }
 
-float Cylinder::intersect(const float origin[3], const float dir[3]) const {
-    // AABB approximation
-    float h = size * 2.0f;
-    float t = -1.0f;
-    if (rayIntersectsAABB(origin, dir, 
-                                  position.x - size, position.y - size, position.z - size,
-                                  position.x + size, position.y + size, position.z + size, t)) {
-        return t;
-    }
-    return -1.0f;
-}
-
 // --- Cone ---
 void Cone::draw() const {
+#ifndef SHAPE_IMMEDIATE_MODE
+    ShapeMeshes::draw(ShapeMeshes::MESH_CONE, segments, position, size, color);
+#else
     glPushMatrix();
     glTranslatef(position.x, position.y, position.z);
     glColor3f(color.x, color.y, color.z);
@@ -309,6 +294,7 @@ void Cone::draw() const {
     glEnd();
     
     glPopMatrix();
+#endif
 }
 
 void Cone::drawWireframe() const {
@@ -335,35 +321,47 @@ void Cone::drawWireframe() const {
     glPopMatrix();
 }
 
-float Cone::intersect(const float origin[3], const float dir[3]) const {
-     // AABB approximation
-    float t = -1.0f;
-    if (rayIntersectsAABB(origin, dir, 
-                                  position.x - size, position.y - size, position.z - size,
-                                  position.x + size, position.y + size, position.z + size, t)) {
-        return t;
-    }
-    return -1.0f;
-}
-
 // ==========================================
 // Scene Implementation
 // ==========================================
 
+// Camera target movement that re-centres the physics LOD bands
+static const float LOD_FOCUS_STEP = 1.0f;
+
+// Physics stand-in for each drawn shape; tricones collide as full cones
+static CollisionShape collisionShapeOf(ShapeType type) {
+    switch (type) {
+        case SHAPE_SPHERE:   return COLLISION_SPHERE;
+        case SHAPE_CYLINDER: return COLLISION_CYLINDER;
+        case SHAPE_CONE:
+        case SHAPE_TRICONE:  return COLLISION_CONE;
+        default:             return COLLISION_BOX;
+    }
+}
+
 Scene::Scene() : lightActive(false), selectedIndex(-1), floorTextureId(0), wallTextureId(0),
                  camera(new Camera()), terrain(nullptr), shadowSystem(nullptr),
                  showTrees(true), treeCount(50) {
     // Default light
     light.color = Vector3(1.0f, 0.9f, 0.7f);
     light.position = Vector3(0.0f, 5.0f, 0.0f);
+
+    // Trees and shapes block each other; the light proxy blocks nothing
+    layerMasks[LAYER_TREES] = 1u << LAYER_SHAPES;
+    layerMasks[LAYER_SHAPES] = (1u << LAYER_TREES) | (1u << LAYER_SHAPES);
+    layerMasks[LAYER_LIGHT] = 0u;
     
     physicsEngine = new PhysicsEngine();
+    physicsThread = new PhysicsThread(*physicsEngine);
+    physicsThread->setPaused(true);
     terrain = new Terrain(50.0f, 128);
     shadowSystem = new ShadowSystem();
 }
 
 Scene::~Scene() {
     delete camera;
+    delete physicsThread;   // Joins the physics thread
+    physicsRecorder.stop(); // Detach before the engine goes away
     delete physicsEngine;
     delete terrain;
     delete shadowSystem;
@@ -398,6 +396,9 @@ void Scene::init() {
     glEnable(GL_COLOR_MATERIAL);
     glEnable(GL_NORMALIZE);
     glClearColor(0.53f, 0.81f, 0.92f, 1.0f);
+#ifndef SHAPE_IMMEDIATE_MODE
+    ShapeMeshes::init();
+#endif
 
     floorTextureId = loadTexture("textures/floor_texture.jpg");
     wallTextureId = loadTexture("textures/wall.jpg");
@@ -406,14 +407,37 @@ void Scene::init() {
     terrain->generate(42);
 
     // Give the physics engine access to terrain height
-    physicsEngine->getTerrainHeight = [this](float x, float z) -> float {
-        return terrain->getHeight(x, z);
+    physicsEngine->sampleTerrainHeights = [this](const float* x, const float* z, float* heights, size_t count) {
+        terrain->sampleHeights(x, z, heights, count);
     };
 
     // Add some default shapes
     addShape(SHAPE_CUBE, 0.0f, 0.0f, 1.0f);
     generateTrees(treeCount);
     lightActive = true;
+
+    // Static proxy so the light can be made solid through its layer
+    PhysicsObject lightDesc;
+    lightDesc.position = light.position;
+    lightDesc.isStatic = true;
+    lightDesc.size = Vector3(0.15f, 0.15f, 0.15f);
+    lightDesc.shape = COLLISION_SPHERE;
+    applyLayer(lightDesc, LAYER_LIGHT);
+    lightBody = physicsThread->withEngine([&lightDesc](PhysicsEngine& engine) {
+        return engine.addObject(lightDesc);
+    });
+
+    // Bodies far from what the camera looks at step at a reduced rate
+    lodFocus = camera->getTarget();
+    Vector3 focus = lodFocus;
+    physicsThread->withEngine([focus](PhysicsEngine& engine) {
+        engine.setLodFocus(std::vector<Vector3>(1, focus));
+        engine.setLodEnabled(true);
+        // Trees and shapes were added in no spatial order
+        engine.setSpatialSortEnabled(true);
+    });
+
+    physicsThread->start();
 }
 
 void Scene::resize(int width, int height) {
@@ -425,19 +449,78 @@ void Scene::resize(int width, int height) {
     glMatrixMode(GL_MODELVIEW);
 }
 
-void Scene::update(float dt) {
-    physicsEngine->update(dt);
-    
-    // Sync graphical shapes with physics objects
+void Scene::setPhysicsRate(float hz) {
+    physicsThread->setRate(hz);
+}
+
+void Scene::setSimulationRunning(bool running) {
+    physicsThread->setPaused(!running);
+}
+
+void Scene::syncShapesFromPhysics() {
+    // Latest published step, read without waiting on the physics thread
+    const PhysicsFrame& frame = physicsThread->acquireFrame();
+    float alpha = frame.alphaAt(std::chrono::steady_clock::now());
+
     for (auto shape : shapes) {
-        if (physicsMap.find(shape) != physicsMap.end()) {
-            PhysicsObject* physObj = physicsMap[shape];
-            shape->position = physObj->position;
-        }
+        auto it = physicsMap.find(shape);
+        if (it == physicsMap.end()) continue;
+        // A body missing from the frame was removed; keep the shape where it is
+        frame.getPosition(it->second, alpha, shape->position);
+    }
+}
+
+// Mesh each shape type draws from
+static void shapeMesh(ShapeType type, ShapeMeshes::MeshKind& kind, int& segments) {
+    switch (type) {
+        case SHAPE_SPHERE:   kind = ShapeMeshes::MESH_SPHERE;   segments = ShapeMeshes::SPHERE_SEGMENTS; break;
+        case SHAPE_CYLINDER: kind = ShapeMeshes::MESH_CYLINDER; segments = ShapeMeshes::CYLINDER_SEGMENTS; break;
+        case SHAPE_CONE:     kind = ShapeMeshes::MESH_CONE;     segments = ShapeMeshes::CONE_SEGMENTS; break;
+        case SHAPE_TRICONE:  kind = ShapeMeshes::MESH_CONE;     segments = ShapeMeshes::TRICONE_SEGMENTS; break;
+        default:             kind = ShapeMeshes::MESH_CUBE;     segments = 0; break;
+    }
+}
+
+void Scene::updateInstances() {
+    for (auto& list : instanceScratch) list.clear();
+    for (auto shape : shapes) {
+        const Vector3& p = shape->position;
+        const Vector3& c = shape->color;
+        instanceScratch[shape->getType()].push_back({ p.x, p.y, p.z, shape->size, c.x, c.y, c.z });
     }
+    // Unchanged lists (everything at rest) cost a compare and no upload
+    for (int type = 0; type < SHAPE_TYPE_COUNT; type++) {
+        shapeInstances[type].update(instanceScratch[type]);
+    }
+}
+
+void Scene::drawOccluders() {
+#ifdef SHAPE_IMMEDIATE_MODE
+    for (auto shape : shapes) shape->draw();
+    if (showTrees) {
+        for (const auto& t : trees) drawTree(t);
+    }
+#else
+    // One draw per shape type and one for the whole forest
+    const Vector3 white(1.0f, 1.0f, 1.0f);
+    ShapeMeshes::begin();
+    for (int type = 0; type < SHAPE_TYPE_COUNT; type++) {
+        ShapeMeshes::MeshKind kind;
+        int segments;
+        shapeMesh((ShapeType)type, kind, segments);
+        ShapeMeshes::drawInstances(kind, segments, shapeInstances[type], white);
+    }
+    ShapeMeshes::end();
+    if (showTrees) forestBatch.draw();
+#endif
 }
 
 void Scene::render() {
+    syncShapesFromPhysics();
+#ifndef SHAPE_IMMEDIATE_MODE
+    updateInstances();
+#endif
+
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
     glLoadIdentity();
     
@@ -447,6 +530,7 @@ void Scene::render() {
     }
     
     camera->applyLookAt();
+    updateLodFocus();
               
     if (lightActive) {
         glEnable(GL_LIGHT0);
@@ -465,26 +549,12 @@ void Scene::render() {
     
     drawWall();
     
-    // Draw all shapes
-    for (auto shape : shapes) {
-        shape->draw();
-    }
-    
-    // Draw trees
-    if (showTrees) {
-        for (const auto& t : trees) {
-            drawTree(t);
-        }
-    }
+    // Draw all shapes and trees
+    drawOccluders();
 
     // Shadows
     if (lightActive && shadowSystem) {
-        shadowSystem->renderShadows(light.position, [this]() {
-            for (auto shape : shapes) shape->draw();
-            if (showTrees) {
-                for (const auto& t : trees) drawTree(t);
-            }
-        });
+        shadowSystem->renderShadows(light.position, [this]() { drawOccluders(); });
     }
     
     // Draw Light wireframe
@@ -534,26 +604,30 @@ void Scene::addShapeAt(ShapeType type, float x, float z, float r, float g, float
         case SHAPE_CUBE: newShape = new Cube(pos, col, size); break;
         case SHAPE_SPHERE: newShape = new Sphere(pos, col, size); break;
         case SHAPE_CYLINDER: newShape = new Cylinder(pos, col, size); break;
-        case SHAPE_CONE: newShape = new Cone(pos, col, size, 32); break;
-        case SHAPE_TRICONE: newShape = new Cone(pos, col, size, 3); break;
+        case SHAPE_CONE: newShape = new Cone(pos, col, size, ShapeMeshes::CONE_SEGMENTS); break;
+        case SHAPE_TRICONE: newShape = new Cone(pos, col, size, ShapeMeshes::TRICONE_SEGMENTS); break;
     }
     
     if (newShape) {
         shapes.push_back(newShape);
         
         // Add to physics engine
-        PhysicsObject* physObj = physicsEngine->addObject(pos);
+        PhysicsObject desc;
+        desc.position = pos;
         // Default properties for now
-        physObj->mass = 1.0f;
-        physObj->mass = 1.0f;
-        physObj->friction = 2.0f; // Reasonable friction
-        physObj->size = Vector3(size, size, size); // Set size
+        desc.mass = 1.0f;
+        desc.friction = 2.0f; // Reasonable friction
+        desc.size = Vector3(size, size, size); // Set size
+        desc.shape = collisionShapeOf(type);
+        applyLayer(desc, LAYER_SHAPES);
         
         if (type == SHAPE_CUBE) {
              // Maybe give cube different properties?
         }
         
-        physicsMap[newShape] = physObj;
+        physicsMap[newShape] = physicsThread->withEngine([&desc](PhysicsEngine& engine) {
+            return engine.addObject(desc);
+        });
     }
 }
 
@@ -578,9 +652,17 @@ float Scene::getTerrainHeight(float x, float z) const {
     return 0.0f;
 }
 
+TerrainRenderStats Scene::getTerrainStats() const {
+    return terrain ? terrain->getRenderStats() : TerrainRenderStats();
+}
+
 void Scene::setLightWorldPos(float x, float y, float z) {
     light.position = Vector3(x, y, z);
     lightActive = true;
+
+    PhysicsHandle body = lightBody;
+    Vector3 pos = light.position;
+    physicsThread->enqueue([body, pos](PhysicsEngine& engine) { engine.setPosition(body, pos); });
 }
 
 Vector3 Scene::getLightPosition() const { return light.position; }
@@ -594,27 +676,32 @@ int Scene::pickObject(float screenX, float screenY, int vpW, int vpH) {
     
     buildScreenRay(screenX, screenY, vpW, vpH, camX, camY, camZ, target.x, target.y, target.z, origin, dir);
 
+    // Test against the positions render() last synced from the published
+    // frame, i.e. where the shapes are drawn, without touching the engine.
+    // The boxes are the body bounds the physics queries use; trees are
+    // not pickable.
     int bestIdx = -1;
     float bestT = 1e30f;
-
     for (int i = 0; i < (int)shapes.size(); i++) {
-        float t = shapes[i]->intersect(origin, dir);
-        if (t > 0 && t < bestT) {
+        const Vector3& p = shapes[i]->position;
+        float s = shapes[i]->size;
+        float t;
+        if (rayIntersectsAABB(origin, dir, p.x - s, p.y - s, p.z - s, p.x + s, p.y + s, p.z + s, t) &&
+            t < bestT) {
             bestT = t;
             bestIdx = i;
         }
     }
 
-    // Light picking
+    // Light picking, against its proxy body's box
     if (lightActive) {
         float ls = 0.15f;
         float t;
         if (rayIntersectsAABB(origin, dir,
-                                      light.position.x - ls, light.position.y - ls, light.position.z - ls,
-                                      light.position.x + ls, light.position.y + ls, light.position.z + ls, t)) {
-            if (t < bestT) {
-                bestIdx = (int)shapes.size();
-            }
+                              light.position.x - ls, light.position.y - ls, light.position.z - ls,
+                              light.position.x + ls, light.position.y + ls, light.position.z + ls, t) &&
+            t < bestT) {
+            bestIdx = (int)shapes.size();
         }
     }
 
@@ -628,6 +715,17 @@ void Scene::moveShape(int index, float x, float z) {
     if (index >= 0 && index < (int)shapes.size()) {
         shapes[index]->position.x = x;
         shapes[index]->position.z = z;
+
+        // Teleport the body along; invalid handles are ignored by the engine
+        PhysicsHandle body = getPhysicsHandle(index);
+        physicsThread->enqueue([body, x, z](PhysicsEngine& engine) {
+            if (!engine.isValid(body)) return;
+            Vector3 pos = engine.getPosition(body);
+            pos.x = x;
+            pos.z = z;
+            engine.setPosition(body, pos);
+            engine.setVelocity(body, Vector3(0,0,0));
+        });
     }
 }
 
@@ -661,17 +759,20 @@ void Scene::changeShapeType(int index, ShapeType newType) {
         case SHAPE_CUBE:     newShape = new Cube(pos, col, sz); break;
         case SHAPE_SPHERE:   newShape = new Sphere(pos, col, sz); break;
         case SHAPE_CYLINDER: newShape = new Cylinder(pos, col, sz); break;
-        case SHAPE_CONE:     newShape = new Cone(pos, col, sz, 32); break;
-        case SHAPE_TRICONE:  newShape = new Cone(pos, col, sz, 3); break;
+        case SHAPE_CONE:     newShape = new Cone(pos, col, sz, ShapeMeshes::CONE_SEGMENTS); break;
+        case SHAPE_TRICONE:  newShape = new Cone(pos, col, sz, ShapeMeshes::TRICONE_SEGMENTS); break;
     }
     if (!newShape) return;
 
     // Transfer physics mapping
     auto it = physicsMap.find(old);
     if (it != physicsMap.end()) {
-        PhysicsObject* physObj = it->second;
+        PhysicsHandle body = it->second;
         physicsMap.erase(it);
-        physicsMap[newShape] = physObj;
+        physicsMap[newShape] = body;
+
+        CollisionShape shape = collisionShapeOf(newType);
+        physicsThread->enqueue([body, shape](PhysicsEngine& engine) { engine.setShape(body, shape); });
     }
 
     shapes[index] = newShape;
@@ -681,13 +782,18 @@ void Scene::changeShapeType(int index, ShapeType newType) {
 void Scene::moveSelectedShape(float dx, float dz) {
     
     if (selectedIndex >= 0 && selectedIndex < (int)shapes.size()) {
-        PhysicsObject* physObj = getPhysicsObject(selectedIndex);
-        if (physObj) {
-            physObj->position.x += dx;
-            physObj->position.z += dz;
-            // Reset velocity/accel if manually moved?
-            physObj->velocity = Vector3(0,0,0);
-            physObj->acceleration = Vector3(0,0,0);
+        PhysicsHandle body = getPhysicsHandle(selectedIndex);
+        if (physicsMap.count(shapes[selectedIndex])) {
+            physicsThread->enqueue([body, dx, dz](PhysicsEngine& engine) {
+                if (!engine.isValid(body)) return;
+                Vector3 pos = engine.getPosition(body);
+                pos.x += dx;
+                pos.z += dz;
+                engine.setPosition(body, pos);
+                // Reset velocity/accel if manually moved?
+                engine.setVelocity(body, Vector3(0,0,0));
+                engine.setAcceleration(body, Vector3(0,0,0));
+            });
         } else {
             shapes[selectedIndex]->position.x += dx;
             shapes[selectedIndex]->position.z += dz;
@@ -695,14 +801,74 @@ void Scene::moveSelectedShape(float dx, float dz) {
     }
 }
 
-PhysicsObject* Scene::getPhysicsObject(int index) {
+void Scene::setSelectedAcceleration(float ax, float az) {
+    PhysicsHandle body = getPhysicsHandle(selectedIndex);
+    physicsThread->enqueue([body, ax, az](PhysicsEngine& engine) {
+        Vector3 accel = engine.getAcceleration(body);
+        accel.x = ax;
+        accel.z = az;
+        engine.setAcceleration(body, accel);
+    });
+}
+
+void Scene::applyLayer(PhysicsObject& desc, SceneLayer layer) const {
+    desc.collisionCategory = 1u << layer;
+    desc.collisionMask = layerMasks[layer];
+}
+
+void Scene::setLayerMask(SceneLayer layer, uint32_t mask) {
+    layerMasks[layer] = mask;
+
+    std::vector<PhysicsHandle> members;
+    if (layer == LAYER_TREES) {
+        for (const auto& t : trees) members.push_back(t.body);
+    } else if (layer == LAYER_SHAPES) {
+        for (const auto& entry : physicsMap) members.push_back(entry.second);
+    } else {
+        members.push_back(lightBody);
+    }
+
+    uint32_t category = 1u << layer;
+    physicsThread->enqueue([members, category, mask](PhysicsEngine& engine) {
+        for (PhysicsHandle body : members) engine.setCollisionFilter(body, category, mask);
+    });
+}
+
+void Scene::updateLodFocus() {
+    // Only re-send the focus once it has moved a noticeable distance
+    Vector3 target = camera->getTarget();
+    if ((target - lodFocus).length() < LOD_FOCUS_STEP) return;
+    lodFocus = target;
+    physicsThread->enqueue([target](PhysicsEngine& engine) {
+        engine.setLodFocus(std::vector<Vector3>(1, target));
+    });
+}
+
+void Scene::setBroadphaseMode(BroadphaseMode mode) {
+    physicsThread->enqueue([mode](PhysicsEngine& engine) { engine.setBroadphaseMode(mode); });
+}
+
+void Scene::startPhysicsRecording() {
+    physicsThread->withEngine([this](PhysicsEngine& engine) { physicsRecorder.start(engine); });
+}
+
+bool Scene::stopPhysicsRecording(const char* path, uint64_t& stateHash) {
+    if (!physicsRecorder.isRecording()) return false;
+    physicsThread->withEngine([this, &stateHash](PhysicsEngine& engine) {
+        physicsRecorder.stop();
+        stateHash = engine.stateHash();
+    });
+    return physicsRecorder.save(path);
+}
+
+PhysicsHandle Scene::getPhysicsHandle(int index) const {
     if (index >= 0 && index < (int)shapes.size()) {
-        Shape* s = shapes[index];
-        if (physicsMap.find(s) != physicsMap.end()) {
-            return physicsMap[s];
+        auto it = physicsMap.find(shapes[index]);
+        if (it != physicsMap.end()) {
+            return it->second;
         }
     }
-    return nullptr;
+    return PhysicsHandle();
 }
 
 void Scene::drawFloor() {
@@ -757,23 +923,28 @@ void Scene::drawLightWireframe(const Vector3& pos, float size) {
 }
 
 void Scene::generateTrees(int count) {
-    // Remove old physics objects
-    for (const auto& t : trees) {
-        if (t.physObj) {
-            physicsEngine->removeObject(t.physObj);
-        }
-    }
-    trees.clear();
+    count = std::max(count, 0);
     treeCount = count;
-    
-    for (int i = 0; i < count; i++) {
+
+    // Swap the bodies in one go so the physics thread never sees half a forest
+    physicsThread->withEngine([&](PhysicsEngine& engine) {
+        removeTrees(engine, 0);
+        addTrees(engine, count);
+    });
+}
+
+// Places 'count' new trees outside the spawn area and bakes them onto
+// the end of the forest batch
+void Scene::addTrees(PhysicsEngine& engine, int count) {
+    for (int i = 0; i < count; ) {
         Tree t;
         // Random position between -40 and 40
         float x = (rand() % 800) / 10.0f - 40.0f;
         float z = (rand() % 800) / 10.0f - 40.0f;
         
-        // Avoid center area (keep spawn clear)
+        // Avoid center area (keep spawn clear); try again elsewhere
         if (x > -5 && x < 5 && z > -5 && z < 5) continue;
+        i++;
         
         // Place tree on terrain surface
         float groundY = terrain ? terrain->getHeight(x, z) : 0.0f;
@@ -782,17 +953,39 @@ void Scene::generateTrees(int count) {
         t.size = (rand() % 150) / 100.0f + 1.5f; 
         
         // Physics
-        PhysicsObject* p = physicsEngine->addObject(t.position);
-        p->isStatic = true;
+        PhysicsObject desc;
+        desc.position = t.position;
+        desc.isStatic = true;
         float trunkRadius = t.size * 0.3f;
         float totalHeight = t.size * 5.0f;
-        p->size = Vector3(trunkRadius, totalHeight, trunkRadius);
+        desc.size = Vector3(trunkRadius, totalHeight, trunkRadius);
+        desc.shape = COLLISION_CYLINDER;
+        applyLayer(desc, LAYER_TREES);
         
-        t.physObj = p;
+        t.body = engine.addObject(desc);
         trees.push_back(t);
+
+        // Same colors as drawTree
+        forestBatch.append(ShapeMeshes::MESH_TREE_TRUNK, ShapeMeshes::TREE_SEGMENTS, t.position, t.size,
+                           Vector3(0.55f, 0.27f, 0.07f));
+        forestBatch.append(ShapeMeshes::MESH_TREE_LEAVES, ShapeMeshes::TREE_SEGMENTS, t.position, t.size,
+                           Vector3(0.0f, 0.8f, 0.0f));
     }
 }
 
+// Drops every tree after the first 'keep', bodies and baked geometry alike
+void Scene::removeTrees(PhysicsEngine& engine, size_t keep) {
+    if (keep >= trees.size()) return;
+    std::vector<PhysicsHandle> oldBodies;
+    oldBodies.reserve(trees.size() - keep);
+    for (size_t i = keep; i < trees.size(); ++i) {
+        oldBodies.push_back(trees[i].body);
+    }
+    engine.removeObjects(oldBodies);
+    trees.resize(keep);
+    forestBatch.truncate(keep * 2);
+}
+
 void Scene::drawTree(const Tree& tree) {
     glPushMatrix();
     glTranslatef(tree.position.x, tree.position.y, tree.position.z);
@@ -857,10 +1050,19 @@ bool Scene::getTreesVisible() const {
     return showTrees;
 }
 
+// Keeps the trees already planted: shrinking drops the newest ones and
+// growing adds more, so only the difference is baked and uploaded
 void Scene::setTreeCount(int count) {
-    if (count != treeCount) {
-        generateTrees(count);
-    }
+    count = std::max(count, 0);
+    if (count == (int)trees.size()) return;
+    physicsThread->withEngine([&](PhysicsEngine& engine) {
+        if (count < (int)trees.size()) {
+            removeTrees(engine, (size_t)count);
+        } else {
+            addTrees(engine, count - (int)trees.size());
+        }
+    });
+    treeCount = (int)trees.size();
 }
 
 int Scene::getTreeCount() const {
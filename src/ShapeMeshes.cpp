@@ -0,0 +1,522 @@
+// Buffer objects are GL 1.5; the prototypes have to be requested before
+// the first include of GL/gl.h
+#define GL_GLEXT_PROTOTYPES
+#include "ShapeMeshes.h"
+#include "MathUtils.h"
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+using ShapeMeshes::MeshKind;
+
+const GLsizei VERTEX_STRIDE = 6 * sizeof(float); // Position, normal
+const size_t BAKED_FLOATS = 9;                    // Position, normal, color
+
+// Generic attributes of the instance data. 6 and 7 are clear of the slots
+// some drivers alias to gl_Vertex, gl_Normal and gl_Color.
+const GLuint INSTANCE_PLACEMENT_ATTRIB = 6; // xyz position, w scale
+const GLuint INSTANCE_COLOR_ATTRIB = 7;
+
+// Fixed function lighting as the scene sets it up: GL_LIGHT0 only, no
+// specular, material ambient and diffuse from the color, per vertex
+const char* INSTANCE_VERTEX_SHADER =
+    "#version 120\n"
+    "attribute vec4 instancePlacement;\n"
+    "attribute vec3 instanceColor;\n"
+    "uniform vec3 tint;\n"
+    "varying vec4 color;\n"
+    "void main() {\n"
+    "    vec4 eye = gl_ModelViewMatrix * vec4(gl_Vertex.xyz * instancePlacement.w + instancePlacement.xyz, 1.0);\n"
+    "    gl_Position = gl_ProjectionMatrix * eye;\n"
+    "    vec3 n = normalize(gl_NormalMatrix * gl_Normal);\n"
+    "    vec4 light = gl_LightSource[0].position;\n"
+    "    vec3 l = normalize(light.xyz - eye.xyz * light.w);\n"
+    "    vec3 base = instanceColor * tint;\n"
+    "    vec3 lit = (gl_LightModel.ambient.rgb + gl_LightSource[0].ambient.rgb) * base +\n"
+    "               max(dot(n, l), 0.0) * gl_LightSource[0].diffuse.rgb * base;\n"
+    "    color = vec4(lit, 1.0);\n"
+    "}\n";
+
+const char* INSTANCE_FRAGMENT_SHADER =
+    "#version 120\n"
+    "varying vec4 color;\n"
+    "void main() {\n"
+    "    gl_FragColor = color;\n"
+    "}\n";
+
+struct Mesh {
+    MeshKind kind;
+    int segments;
+    size_t firstVertex;
+    size_t vertexCount;
+    size_t firstIndex;
+    GLsizei indexCount;
+};
+
+// Every mesh lives in one vertex and one index buffer, so a batch of
+// shapes binds them once
+std::vector<Mesh> meshes;
+std::vector<float> vertices;
+std::vector<GLuint> indices;
+GLuint vertexBuffer = 0;
+GLuint indexBuffer = 0;
+bool batching = false;
+bool uploadPending = false; // Meshes built since the last upload()
+GLuint instanceProgram = 0; // 0 when instancing is unavailable
+GLint tintLocation = -1;
+
+GLuint addVertex(float x, float y, float z, float nx, float ny, float nz) {
+    GLuint index = (GLuint)(vertices.size() / 6);
+    float v[6] = { x, y, z, nx, ny, nz };
+    vertices.insert(vertices.end(), v, v + 6);
+    return index;
+}
+
+void addTriangle(GLuint a, GLuint b, GLuint c) {
+    indices.push_back(a);
+    indices.push_back(b);
+    indices.push_back(c);
+}
+
+// ================================================================
+// Unit meshes, vertex for vertex the immediate mode shapes at size 1
+// ================================================================
+void buildCube() {
+    const float faces[6][5][3] = {
+        { { 0, 0, 1 }, { -1, -1, 1 }, { 1, -1, 1 }, { 1, 1, 1 }, { -1, 1, 1 } },
+        { { 0, 0, -1 }, { -1, -1, -1 }, { -1, 1, -1 }, { 1, 1, -1 }, { 1, -1, -1 } },
+        { { 0, 1, 0 }, { -1, 1, -1 }, { -1, 1, 1 }, { 1, 1, 1 }, { 1, 1, -1 } },
+        { { 0, -1, 0 }, { -1, -1, -1 }, { 1, -1, -1 }, { 1, -1, 1 }, { -1, -1, 1 } },
+        { { 1, 0, 0 }, { 1, -1, -1 }, { 1, 1, -1 }, { 1, 1, 1 }, { 1, -1, 1 } },
+        { { -1, 0, 0 }, { -1, -1, -1 }, { -1, -1, 1 }, { -1, 1, 1 }, { -1, 1, -1 } },
+    };
+    for (const auto& f : faces) {
+        GLuint q[4];
+        for (int k = 0; k < 4; k++) {
+            q[k] = addVertex(f[k + 1][0], f[k + 1][1], f[k + 1][2], f[0][0], f[0][1], f[0][2]);
+        }
+        addTriangle(q[0], q[1], q[2]);
+        addTriangle(q[0], q[2], q[3]);
+    }
+}
+
+// UV sphere of radius 1, Y up; the quad strips become triangle pairs
+void buildSphere(int segments) {
+    GLuint first = (GLuint)(vertices.size() / 6);
+    for (int i = 0; i <= segments; i++) {
+        float th = (float)i / segments * M_PI - M_PI / 2;
+        float y = sin(th);
+        float r = cos(th);
+        for (int j = 0; j <= segments; j++) {
+            float phi = (float)j / segments * 2 * M_PI;
+            float x = r * sin(phi);
+            float z = r * cos(phi);
+            addVertex(x, y, z, x, y, z);
+        }
+    }
+    for (int i = 0; i < segments; i++) {
+        for (int j = 0; j < segments; j++) {
+            GLuint v00 = first + i * (segments + 1) + j;
+            GLuint v10 = v00 + segments + 1;
+            addTriangle(v00, v10, v10 + 1);
+            addTriangle(v00, v10 + 1, v00 + 1);
+        }
+    }
+}
+
+// Downward fan closing the bottom of a cylinder or cone at y = -1
+void buildBottomCap(int segments) {
+    GLuint center = addVertex(0, -1, 0, 0, -1, 0);
+    for (int i = segments; i >= 0; i--) {
+        float a = 2 * M_PI * i / segments;
+        GLuint rim = addVertex(sin(a), -1, cos(a), 0, -1, 0);
+        if (i < segments) addTriangle(center, rim - 1, rim);
+    }
+}
+
+void buildCylinder(int segments) {
+    GLuint center = addVertex(0, 1, 0, 0, 1, 0);
+    for (int i = 0; i <= segments; i++) {
+        float a = 2 * M_PI * i / segments;
+        GLuint rim = addVertex(sin(a), 1, cos(a), 0, 1, 0);
+        if (i > 0) addTriangle(center, rim - 1, rim);
+    }
+
+    buildBottomCap(segments);
+
+    for (int i = 0; i <= segments; i++) {
+        float a = 2 * M_PI * i / segments;
+        float x = sin(a);
+        float z = cos(a);
+        GLuint top = addVertex(x, 1, z, x, 0, z);
+        addVertex(x, -1, z, x, 0, z);
+        if (i > 0) {
+            addTriangle(top - 2, top - 1, top + 1);
+            addTriangle(top - 2, top + 1, top);
+        }
+    }
+}
+
+// Height 2, radius 1: the side normals lean up by r / h
+void buildCone(int segments) {
+    buildBottomCap(segments);
+
+    GLuint tip = addVertex(0, 1, 0, 0, 1, 0);
+    for (int i = 0; i <= segments; i++) {
+        float a = 2 * M_PI * i / segments;
+        float x = sin(a);
+        float z = cos(a);
+        float ny = 0.5f;
+        float len = sqrt(x * x + ny * ny + z * z);
+        GLuint rim = addVertex(x, -1, z, x / len, ny / len, z / len);
+        if (i > 0) addTriangle(tip, rim - 1, rim);
+    }
+}
+
+// The scene's tree at size 1: an 8-sided trunk and a cone of leaves on top
+void buildTreeTrunk(int segments) {
+    const float r = 0.2f;
+    const float h = 1.5f;
+    for (int i = 0; i <= segments; i++) {
+        float a = 2 * M_PI * i / segments;
+        GLuint top = addVertex(cos(a) * r, h, sin(a) * r, cos(a), 0, sin(a));
+        addVertex(cos(a) * r, 0, sin(a) * r, cos(a), 0, sin(a));
+        if (i > 0) {
+            addTriangle(top - 2, top - 1, top + 1);
+            addTriangle(top - 2, top + 1, top);
+        }
+    }
+}
+
+void buildTreeLeaves(int segments) {
+    const float r = 0.8f;
+    const float h = 2.5f;
+    const float base = 1.5f * 0.8f; // Overlaps the trunk slightly
+
+    GLuint tip = addVertex(0, base + h, 0, 0, 1, 0);
+    for (int i = 0; i <= segments; i++) {
+        float a = 2 * M_PI * i / segments;
+        float x = cos(a) * r;
+        float z = sin(a) * r;
+        float len = sqrt(x * x + 0.25f + z * z);
+        GLuint rim = addVertex(x, base, z, x / len, 0.5f / len, z / len);
+        if (i > 0) addTriangle(tip, rim - 1, rim);
+    }
+
+    GLuint center = addVertex(0, base, 0, 0, -1, 0);
+    for (int i = segments; i >= 0; i--) {
+        float a = 2 * M_PI * i / segments;
+        GLuint rim = addVertex(cos(a) * r, base, sin(a) * r, 0, -1, 0);
+        if (i < segments) addTriangle(center, rim - 1, rim);
+    }
+}
+
+void upload() {
+    if (vertexBuffer == 0) {
+        glGenBuffers(1, &vertexBuffer);
+        glGenBuffers(1, &indexBuffer);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    uploadPending = false;
+}
+
+// Sends data[uploaded, size) to 'buffer', reallocating it (and sending
+// everything) when it has outgrown 'capacity'. Sizes are in elements.
+template <typename T>
+void uploadTail(GLenum target, GLuint buffer, const std::vector<T>& data, size_t& uploaded, size_t& capacity) {
+    glBindBuffer(target, buffer);
+    if (data.size() > capacity) {
+        capacity = std::max(data.size(), capacity * 2);
+        glBufferData(target, capacity * sizeof(T), nullptr, GL_STATIC_DRAW);
+        uploaded = 0;
+    }
+    if (uploaded < data.size()) {
+        glBufferSubData(target, uploaded * sizeof(T), (data.size() - uploaded) * sizeof(T), data.data() + uploaded);
+        uploaded = data.size();
+    }
+}
+
+// Appends the mesh to the CPU copies; upload() sends them to the GPU
+const Mesh& build(MeshKind kind, int segments) {
+    Mesh mesh;
+    mesh.kind = kind;
+    mesh.segments = segments;
+    mesh.firstVertex = vertices.size() / 6;
+    mesh.firstIndex = indices.size();
+    switch (kind) {
+        case ShapeMeshes::MESH_CUBE: buildCube(); break;
+        case ShapeMeshes::MESH_SPHERE: buildSphere(segments); break;
+        case ShapeMeshes::MESH_CYLINDER: buildCylinder(segments); break;
+        case ShapeMeshes::MESH_CONE: buildCone(segments); break;
+        case ShapeMeshes::MESH_TREE_TRUNK: buildTreeTrunk(segments); break;
+        case ShapeMeshes::MESH_TREE_LEAVES: buildTreeLeaves(segments); break;
+    }
+    mesh.vertexCount = vertices.size() / 6 - mesh.firstVertex;
+    mesh.indexCount = (GLsizei)(indices.size() - mesh.firstIndex);
+    meshes.push_back(mesh);
+    uploadPending = true;
+    return meshes.back();
+}
+
+// CPU copy only, so static batches can be baked without a GL context
+const Mesh& lookup(MeshKind kind, int segments) {
+    if (kind == ShapeMeshes::MESH_CUBE) segments = 0;
+    for (const Mesh& mesh : meshes) {
+        if (mesh.kind == kind && mesh.segments == segments) return mesh;
+    }
+    return build(kind, segments);
+}
+
+const Mesh& find(MeshKind kind, int segments) {
+    const Mesh& mesh = lookup(kind, segments);
+    if (uploadPending) upload(); // Rare: a segment count init() did not know about
+    return mesh;
+}
+
+// ================================================================
+// Instancing setup
+// ================================================================
+bool hasExtension(const char* name) {
+    const char* list = (const char*)glGetString(GL_EXTENSIONS);
+    size_t length = strlen(name);
+    for (const char* p = list ? strstr(list, name) : nullptr; p; p = strstr(p + length, name)) {
+        if ((p == list || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0')) return true;
+    }
+    return false;
+}
+
+GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (ok != GL_TRUE) {
+        char log[512] = "";
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        std::cerr << "Instance shader failed to compile: " << log << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+// Leaves instanceProgram at 0 if anything is missing
+void initInstancing() {
+    const char* version = (const char*)glGetString(GL_VERSION);
+    if (!version || std::atoi(version) < 2) return; // No GLSL before GL 2.0
+    if (!hasExtension("GL_ARB_instanced_arrays") || !hasExtension("GL_ARB_draw_instanced")) return;
+
+    GLuint vs = compileShader(GL_VERTEX_SHADER, INSTANCE_VERTEX_SHADER);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, INSTANCE_FRAGMENT_SHADER);
+    if (vs && fs) {
+        GLuint program = glCreateProgram();
+        glAttachShader(program, vs);
+        glAttachShader(program, fs);
+        glBindAttribLocation(program, INSTANCE_PLACEMENT_ATTRIB, "instancePlacement");
+        glBindAttribLocation(program, INSTANCE_COLOR_ATTRIB, "instanceColor");
+        glLinkProgram(program);
+        GLint ok = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (ok == GL_TRUE) {
+            instanceProgram = program;
+            tintLocation = glGetUniformLocation(program, "tint");
+        } else {
+            std::cerr << "Instance shader failed to link" << std::endl;
+            glDeleteProgram(program);
+        }
+    }
+    // The program keeps the compiled code; the shaders go with it
+    if (vs) glDeleteShader(vs);
+    if (fs) glDeleteShader(fs);
+}
+
+} // namespace
+
+void ShapeMeshes::init() {
+    if (vertexBuffer != 0) return;
+    lookup(MESH_CUBE, 0);
+    lookup(MESH_SPHERE, SPHERE_SEGMENTS);
+    lookup(MESH_CYLINDER, CYLINDER_SEGMENTS);
+    lookup(MESH_CONE, CONE_SEGMENTS);
+    lookup(MESH_CONE, TRICONE_SEGMENTS);
+    lookup(MESH_TREE_TRUNK, TREE_SEGMENTS);
+    lookup(MESH_TREE_LEAVES, TREE_SEGMENTS);
+    upload();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    initInstancing();
+}
+
+bool ShapeMeshes::isInstancingAvailable() {
+    return instanceProgram != 0;
+}
+
+void ShapeMeshes::begin() {
+#ifndef SHAPE_IMMEDIATE_MODE
+    if (vertexBuffer == 0) init();
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, VERTEX_STRIDE, (const void*)0);
+    glNormalPointer(GL_FLOAT, VERTEX_STRIDE, (const void*)(3 * sizeof(float)));
+    batching = true;
+#endif
+}
+
+void ShapeMeshes::end() {
+#ifndef SHAPE_IMMEDIATE_MODE
+    batching = false;
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+#endif
+}
+
+void ShapeMeshes::draw(MeshKind kind, int segments, const Vector3& position, float size, const Vector3& color) {
+    bool single = !batching;
+    if (single) begin();
+
+    const Mesh& mesh = find(kind, segments);
+    glPushMatrix();
+    glTranslatef(position.x, position.y, position.z);
+    glScalef(size, size, size);
+    glColor3f(color.x, color.y, color.z);
+    glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+                   (const void*)(mesh.firstIndex * sizeof(GLuint)));
+    glPopMatrix();
+
+    if (single) end();
+}
+
+// ================================================================
+// Instanced draws
+// ================================================================
+ShapeMeshes::InstanceBatch::InstanceBatch() : buffer(0) {}
+
+bool ShapeMeshes::InstanceBatch::update(const std::vector<Instance>& next) {
+    if (next.size() == instances.size() &&
+        (next.empty() || memcmp(next.data(), instances.data(), next.size() * sizeof(Instance)) == 0)) {
+        return false;
+    }
+    instances = next;
+
+    // Without instancing the CPU copy is all drawInstances() needs
+    if (instanceProgram == 0) return true;
+    if (buffer == 0) glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(Instance), instances.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, batching ? vertexBuffer : 0);
+    return true;
+}
+
+void ShapeMeshes::drawInstances(MeshKind kind, int segments, const InstanceBatch& batch, const Vector3& tint) {
+    if (batch.instances.empty()) return;
+    bool single = !batching;
+    if (single) begin();
+
+    if (instanceProgram == 0 || batch.buffer == 0) {
+        for (const Instance& in : batch.instances) {
+            draw(kind, segments, Vector3(in.x, in.y, in.z), in.scale,
+                 Vector3(in.r * tint.x, in.g * tint.y, in.b * tint.z));
+        }
+    } else {
+        const Mesh& mesh = find(kind, segments);
+        glUseProgram(instanceProgram);
+        glUniform3f(tintLocation, tint.x, tint.y, tint.z);
+
+        // Mesh arrays were set up by begin(); only the instance data is added
+        glBindBuffer(GL_ARRAY_BUFFER, batch.buffer);
+        glEnableVertexAttribArray(INSTANCE_PLACEMENT_ATTRIB);
+        glEnableVertexAttribArray(INSTANCE_COLOR_ATTRIB);
+        glVertexAttribPointer(INSTANCE_PLACEMENT_ATTRIB, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (const void*)0);
+        glVertexAttribPointer(INSTANCE_COLOR_ATTRIB, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+                              (const void*)(4 * sizeof(float)));
+        glVertexAttribDivisorARB(INSTANCE_PLACEMENT_ATTRIB, 1);
+        glVertexAttribDivisorARB(INSTANCE_COLOR_ATTRIB, 1);
+
+        glDrawElementsInstancedARB(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+                                   (const void*)(mesh.firstIndex * sizeof(GLuint)),
+                                   (GLsizei)batch.instances.size());
+
+        glVertexAttribDivisorARB(INSTANCE_PLACEMENT_ATTRIB, 0);
+        glVertexAttribDivisorARB(INSTANCE_COLOR_ATTRIB, 0);
+        glDisableVertexAttribArray(INSTANCE_PLACEMENT_ATTRIB);
+        glDisableVertexAttribArray(INSTANCE_COLOR_ATTRIB);
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glUseProgram(0);
+    }
+
+    if (single) end();
+}
+
+// ================================================================
+// Static batches
+// ================================================================
+ShapeMeshes::StaticBatch::StaticBatch()
+    : uploadedVertices(0), uploadedIndices(0), vertexCapacity(0), indexCapacity(0),
+      vertexBuffer(0), indexBuffer(0) {}
+
+void ShapeMeshes::StaticBatch::append(MeshKind kind, int segments, const Vector3& position, float size,
+                                      const Vector3& color) {
+    const Mesh mesh = lookup(kind, segments); // Copy: lookup() may grow 'meshes'
+    GLuint base = (GLuint)(baked.size() / BAKED_FLOATS);
+
+    for (size_t v = mesh.firstVertex; v < mesh.firstVertex + mesh.vertexCount; ++v) {
+        const float* src = &vertices[v * 6];
+        float out[BAKED_FLOATS] = {
+            position.x + src[0] * size, position.y + src[1] * size, position.z + src[2] * size,
+            src[3], src[4], src[5],
+            color.x, color.y, color.z
+        };
+        baked.insert(baked.end(), out, out + BAKED_FLOATS);
+    }
+    for (GLsizei i = 0; i < mesh.indexCount; ++i) {
+        bakedIndices.push_back(base + (indices[mesh.firstIndex + i] - (GLuint)mesh.firstVertex));
+    }
+    partEnds.push_back({ baked.size(), bakedIndices.size() });
+}
+
+void ShapeMeshes::StaticBatch::truncate(size_t parts) {
+    if (parts >= partEnds.size()) return;
+    partEnds.resize(parts);
+    baked.resize(parts ? partEnds.back().vertices : 0);
+    bakedIndices.resize(parts ? partEnds.back().indices : 0);
+    uploadedVertices = std::min(uploadedVertices, baked.size());
+    uploadedIndices = std::min(uploadedIndices, bakedIndices.size());
+}
+
+void ShapeMeshes::StaticBatch::draw() {
+    if (bakedIndices.empty()) return;
+    if (vertexBuffer == 0) {
+        glGenBuffers(1, &vertexBuffer);
+        glGenBuffers(1, &indexBuffer);
+    }
+    uploadTail(GL_ARRAY_BUFFER, vertexBuffer, baked, uploadedVertices, vertexCapacity);
+    uploadTail(GL_ELEMENT_ARRAY_BUFFER, indexBuffer, bakedIndices, uploadedIndices, indexCapacity);
+
+    const GLsizei stride = BAKED_FLOATS * sizeof(float);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, stride, (const void*)0);
+    glNormalPointer(GL_FLOAT, stride, (const void*)(3 * sizeof(float)));
+    glColorPointer(3, GL_FLOAT, stride, (const void*)(6 * sizeof(float)));
+    glDrawElements(GL_TRIANGLES, (GLsizei)bakedIndices.size(), GL_UNSIGNED_INT, (const void*)0);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
@@ -1,12 +1,14 @@
 #include "Terrain.h"
 #include <cstdlib>
+#include <algorithm>
 #include <iostream>
 
 // ================================================================
 // Constructor / Destructor
 // ================================================================
 Terrain::Terrain(float worldSize, int gridRes)
-    : worldSize(worldSize), gridRes(gridRes) {
+    : worldSize(worldSize), gridRes(gridRes),
+      vertexBuffer(0), indexBuffer(0), meshDirty(true) {
     heightmap.resize((gridRes + 1) * (gridRes + 1), 0.0f);
 }
 
@@ -19,62 +21,37 @@ Terrain::~Terrain() {
 void Terrain::generate(unsigned int seed) {
     // Flat terrain, so just fill with 0
     std::fill(heightmap.begin(), heightmap.end(), 0.0f);
+    meshDirty = true;
 }
 
 // ================================================================
-// Get height at world position (Flat)
+// Heightfield view for the sampling kernels
 // ================================================================
-float Terrain::getHeight(float x, float z) const {
-    return 0.0f;
+PhysicsKernels::Heightfield Terrain::field() const {
+    PhysicsKernels::Heightfield f;
+    f.heights = heightmap.data();
+    f.res = gridRes;
+    f.origin = -worldSize;
+    f.cellSize = (2.0f * worldSize) / gridRes;
+    return f;
 }
 
 // ================================================================
-// Get terrain normal at world position (Flat)
+// Get height at world position
 // ================================================================
-Vector3 Terrain::getNormal(float x, float z) const {
-    return Vector3(0.0f, 1.0f, 0.0f);
+float Terrain::getHeight(float x, float z) const {
+    float h;
+    sampleHeights(&x, &z, &h, 1);
+    return h;
+}
+
+void Terrain::sampleHeights(const float* x, const float* z, float* out, size_t count) const {
+    PhysicsKernels::sampleHeightfield(field(), x, z, out, count);
 }
 
 // ================================================================
-// Render the terrain mesh
+// Get terrain normal at world position (Flat)
 // ================================================================
-void Terrain::render(GLuint textureId) const {
-    float cellSize = (2.0f * worldSize) / gridRes;
-
-    bool hasTexture = (textureId != 0);
-    if (hasTexture) {
-        glEnable(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D, textureId);
-        glColor3f(1.0f, 1.0f, 1.0f); 
-    } else {
-        glColor3f(0.1f, 0.6f, 0.1f);
-    }
-
-    // Render as triangle strips, row by row
-    float texScale = 0.1f; // Texture repeat every 10 world units
-    
-    // Normal is always up
-    glNormal3f(0.0f, 1.0f, 0.0f);
-
-    for (int iz = 0; iz < gridRes; iz++) {
-        glBegin(GL_TRIANGLE_STRIP);
-        for (int ix = 0; ix <= gridRes; ix++) {
-            // Two vertices per column: current row and next row
-            for (int row = 1; row >= 0; row--) {
-                int z_idx = iz + row;
-                float wx = -worldSize + ix * cellSize;
-                float wz = -worldSize + z_idx * cellSize;
-                
-                // Texture coordinates
-                glTexCoord2f(wx * texScale, wz * texScale);
-
-                glVertex3f(wx, 0.0f, wz);
-            }
-        }
-        glEnd();
-    }
-
-    if (hasTexture) {
-        glDisable(GL_TEXTURE_2D);
-    }
+Vector3 Terrain::getNormal(float x, float z) const {
+    return Vector3(0.0f, 1.0f, 0.0f);
 }
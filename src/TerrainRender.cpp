@@ -0,0 +1,153 @@
+// Buffer objects are GL 1.5; the prototypes have to be requested before
+// the first include of GL/gl.h
+#define GL_GLEXT_PROTOTYPES
+#include "Terrain.h"
+#include "MathUtils.h"
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <algorithm>
+
+namespace {
+
+const float TEX_SCALE = 0.1f; // Texture repeat every 10 world units
+const GLsizei VERTEX_STRIDE = 5 * sizeof(float); // Position, texture coordinates
+
+} // namespace
+
+// ================================================================
+// Build the terrain mesh into GL buffers
+// ================================================================
+void Terrain::buildMesh() {
+    const int side = gridRes + 1;
+    const float cellSize = (2.0f * worldSize) / gridRes;
+
+    std::vector<float> vertices;
+    vertices.reserve(side * side * 5);
+    for (int iz = 0; iz < side; iz++) {
+        float wz = -worldSize + iz * cellSize;
+        for (int ix = 0; ix < side; ix++) {
+            float wx = -worldSize + ix * cellSize;
+            float v[5] = { wx, heightmap[iz * side + ix], wz, wx * TEX_SCALE, wz * TEX_SCALE };
+            vertices.insert(vertices.end(), v, v + 5);
+        }
+    }
+
+    // Within a chunk, one strip per row with two vertices per column (next
+    // row first), joined by repeating the last vertex of a row and the first
+    // of the next; chunks are joined the same way. Every row and every join
+    // adds an even count, so the winding holds across the joins.
+    std::vector<GLuint> indices;
+    chunks.clear();
+    for (int cz = 0; cz < gridRes; cz += CHUNK_CELLS) {
+        for (int cx = 0; cx < gridRes; cx += CHUNK_CELLS) {
+            const int x1 = std::min(cx + CHUNK_CELLS, gridRes);
+            const int z1 = std::min(cz + CHUNK_CELLS, gridRes);
+
+            Chunk chunk;
+            chunk.minX = -worldSize + cx * cellSize;
+            chunk.maxX = -worldSize + x1 * cellSize;
+            chunk.minZ = -worldSize + cz * cellSize;
+            chunk.maxZ = -worldSize + z1 * cellSize;
+            chunk.minY = chunk.maxY = heightmap[cz * side + cx];
+            for (int iz = cz; iz <= z1; iz++) {
+                for (int ix = cx; ix <= x1; ix++) {
+                    chunk.minY = std::min(chunk.minY, heightmap[iz * side + ix]);
+                    chunk.maxY = std::max(chunk.maxY, heightmap[iz * side + ix]);
+                }
+            }
+
+            if (!indices.empty()) {
+                indices.push_back(indices.back());
+                indices.push_back((cz + 1) * side + cx);
+            }
+            chunk.firstIndex = (int)indices.size();
+            for (int iz = cz; iz < z1; iz++) {
+                if (iz > cz) {
+                    indices.push_back(indices.back());
+                    indices.push_back((iz + 1) * side + cx);
+                }
+                for (int ix = cx; ix <= x1; ix++) {
+                    indices.push_back((iz + 1) * side + ix);
+                    indices.push_back(iz * side + ix);
+                }
+            }
+            chunk.indexCount = (int)indices.size() - chunk.firstIndex;
+            chunks.push_back(chunk);
+        }
+    }
+
+    if (vertexBuffer == 0) {
+        glGenBuffers(1, &vertexBuffer);
+        glGenBuffers(1, &indexBuffer);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    meshDirty = false;
+}
+
+// ================================================================
+// Render the terrain mesh
+// ================================================================
+void Terrain::render(unsigned int textureId) {
+    if (meshDirty) buildMesh();
+
+    bool hasTexture = (textureId != 0);
+    if (hasTexture) {
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        glColor3f(1.0f, 1.0f, 1.0f); 
+    } else {
+        glColor3f(0.1f, 0.6f, 0.1f);
+    }
+
+    // Normal is always up
+    glNormal3f(0.0f, 1.0f, 0.0f);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, VERTEX_STRIDE, (const void*)0);
+    glTexCoordPointer(2, GL_FLOAT, VERTEX_STRIDE, (const void*)(3 * sizeof(float)));
+
+    // Visible chunks that are neighbours in the index buffer are drawn as
+    // one strip, joins included
+    float projection[16], modelview[16];
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+    const Frustum frustum = Frustum::fromMatrices(projection, modelview);
+
+    stats = TerrainRenderStats();
+    int runFirst = -1;
+    int runEnd = 0;
+    for (size_t i = 0; i <= chunks.size(); i++) {
+        bool visible = false;
+        if (i < chunks.size()) {
+            const Chunk& c = chunks[i];
+            visible = frustum.intersectsAABB(c.minX, c.minY, c.minZ, c.maxX, c.maxY, c.maxZ);
+            if (visible) {
+                stats.chunksDrawn++;
+                if (runFirst < 0) runFirst = c.firstIndex;
+                runEnd = c.firstIndex + c.indexCount;
+            } else {
+                stats.chunksCulled++;
+            }
+        }
+        if (!visible && runFirst >= 0) {
+            glDrawElements(GL_TRIANGLE_STRIP, runEnd - runFirst, GL_UNSIGNED_INT,
+                           (const void*)(runFirst * sizeof(GLuint)));
+            stats.drawCalls++;
+            runFirst = -1;
+        }
+    }
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    if (hasTexture) {
+        glDisable(GL_TEXTURE_2D);
+    }
+}